@@ -0,0 +1,86 @@
+'use strict';
+
+const CompactDistribution = require('../src/CompactDistribution');
+
+function make_cp(values, ps) {
+	const total = ps.reduce((a, b) => a + b, 0);
+	const cumulativeP = new Float64Array(values.length * 3);
+	let cp = 0;
+	for(let i = 0; i < values.length; ++ i) {
+		cp += ps[i];
+		cumulativeP[i * 3] = cp / total;
+		cumulativeP[i * 3 + 1] = ps[i] / total;
+		cumulativeP[i * 3 + 2] = values[i];
+	}
+	return cumulativeP;
+}
+
+function make_large_cp(n) {
+	const values = [];
+	const ps = [];
+	let v = 0;
+	for(let i = 0; i < n; ++ i) {
+		values.push(v);
+		ps.push(1 + Math.sin(i) * 0.5);
+		v += 25 * (1 + (i % 7) + ((i % 13) === 0 ? 500 : 0));
+	}
+	return make_cp(values, ps);
+}
+
+describe('CompactDistribution', () => {
+	it('round-trips a distribution', () => {
+		const cumulativeP = make_cp(
+			[0, 25, 50, 1000],
+			[0.5, 0.25, 0.125, 0.125]
+		);
+		const dist = new CompactDistribution(
+			CompactDistribution.encode(cumulativeP)
+		);
+
+		expect(dist.length).toEqual(4);
+		expect(dist.expand()).toEqual(cumulativeP);
+	});
+
+	it('uses fewer bytes than the packed representation', () => {
+		const cumulativeP = make_large_cp(5000);
+		const compact = CompactDistribution.encode(cumulativeP);
+
+		expect(compact.byteLength * 3).toBeLessThan(cumulativeP.byteLength);
+	});
+
+	it('returns null for values which cannot be encoded', () => {
+		const cumulativeP = make_cp([0, 0.5, 1], [1, 1, 1]);
+
+		expect(CompactDistribution.encode(cumulativeP)).toBeNull();
+	});
+
+	it('reads individual elements', () => {
+		const cumulativeP = make_large_cp(1000);
+		const dist = new CompactDistribution(
+			CompactDistribution.encode(cumulativeP)
+		);
+
+		for(const i of [0, 1, 31, 32, 33, 500, 999]) {
+			expect(dist.read(i, 2)).toEqual(cumulativeP[i * 3 + 2]);
+			expect(dist.read(i, 1)).toBeNear(cumulativeP[i * 3 + 1], 1e-9);
+			expect(dist.read(i, 0)).toBeNear(cumulativeP[i * 3], 1e-7);
+		}
+	});
+
+	it('finds the last element matching a monotonic condition', () => {
+		const cumulativeP = make_large_cp(1000);
+		const dist = new CompactDistribution(
+			CompactDistribution.encode(cumulativeP)
+		);
+
+		for(const i of [0, 1, 31, 32, 63, 64, 500, 998, 999]) {
+			const value = cumulativeP[i * 3 + 2];
+			const cp = cumulativeP[i * 3];
+
+			expect(dist.find_last(2, (v) => (v <= value))).toEqual(i);
+			expect(dist.find_last(0, (c) => (c < cp - 1e-6))).toEqual(
+				Math.max(i - 1, 0)
+			);
+		}
+	});
+});
@@ -0,0 +1,84 @@
+'use strict';
+
+const Convolution = require('../src/Convolution');
+
+function make_cp(data) {
+	const cumulativeP = new Float64Array(data.length * 3);
+	for(let i = 0; i < data.length; ++ i) {
+		const x = i * 3;
+		const d = data[i];
+		cumulativeP[x] = d.cp;
+		cumulativeP[x + 1] = d.p;
+		cumulativeP[x + 2] = d.value;
+	}
+	return cumulativeP;
+}
+
+const make_array = (length) => new Float64Array(length);
+
+describe('Convolution', () => {
+	it('combines distributions into the distribution of their sum', () => {
+		const a = make_cp([
+			{cp: 0.5, p: 0.5, value: 0},
+			{cp: 1.0, p: 0.5, value: 25},
+		]);
+		const b = make_cp([
+			{cp: 0.75, p: 0.75, value: 50},
+			{cp: 1.00, p: 0.25, value: 100},
+		]);
+
+		const {cumulativeP} = Convolution.convolve_all(
+			[a, b],
+			{quantum: 25},
+			make_array
+		);
+
+		expect(cumulativeP).toEqual(make_cp([
+			{cp: 0.375, p: 0.375, value: 50},
+			{cp: 0.750, p: 0.375, value: 75},
+			{cp: 0.875, p: 0.125, value: 100},
+			{cp: 1.000, p: 0.125, value: 125},
+		]));
+	});
+
+	it('splits values between quanta, preserving the mean', () => {
+		const a = make_cp([
+			{cp: 0.5, p: 0.5, value: 0},
+			{cp: 1.0, p: 0.5, value: 3},
+		]);
+
+		const {cumulativeP} = Convolution.convolve_all(
+			[a],
+			{quantum: 2},
+			make_array
+		);
+
+		expect(cumulativeP).toEqual(make_cp([
+			{cp: 0.50, p: 0.50, value: 0},
+			{cp: 0.75, p: 0.25, value: 2},
+			{cp: 1.00, p: 0.25, value: 4},
+		]));
+	});
+
+	it('does not split values which are multiples of the quantum', () => {
+		const a = make_cp([{cp: 1, p: 1, value: 0.3}]);
+
+		const {cumulativeP} = Convolution.convolve_all(
+			[a],
+			{quantum: 0.1},
+			make_array
+		);
+
+		expect(cumulativeP.length).toEqual(3);
+		expect(cumulativeP[2]).toBeNear(0.3, 1e-12);
+	});
+
+	it('chooses the common unit of all values as the quantum', () => {
+		expect(Convolution.choose_quantum([0, 25, 50, 1000], 5000, 1000))
+			.toEqual(25);
+		expect(Convolution.choose_quantum([0, 25, 50], 100000, 1000))
+			.toEqual(100);
+		expect(Convolution.choose_quantum([0, 0.5, 1.5], 1000, 100))
+			.toEqual(10);
+	});
+});
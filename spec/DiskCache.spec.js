@@ -0,0 +1,162 @@
+'use strict';
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const {DiskCache} = require('../src/DiskCache');
+const Raffle = require('../src/Raffle');
+
+const TASK = {
+	pCutoff: 1e-10,
+	prizes: [
+		{count: 1, value: 10},
+		{count: 7, value: 0},
+	],
+	tickets: 2,
+	type: 'generate',
+};
+
+const RESULT = {
+	cumulativeP: Float64Array.from([0.75, 0.75, 0, 1, 0.25, 10]),
+	normalisation: 0.999,
+};
+
+function make_temp_dir() {
+	return new Promise((resolve, reject) => {
+		fs.mkdtemp(path.join(os.tmpdir(), 'raffle-'), (err, dir) => (
+			err ? reject(err) : resolve(dir)
+		));
+	});
+}
+
+function list_dir(dir) {
+	return new Promise((resolve, reject) => {
+		fs.readdir(dir, (err, files) => (err ? reject(err) : resolve(files)));
+	});
+}
+
+describe('DiskCache', () => {
+	let cache = null;
+	let dir = null;
+
+	beforeEach(async () => {
+		dir = await make_temp_dir();
+		cache = new DiskCache({dir: path.join(dir, 'store')});
+	});
+
+	afterEach((done) => {
+		fs.rm(dir, {force: true, recursive: true}, () => done());
+	});
+
+	it('returns null for missing entries', async () => {
+		expect(await cache.read(TASK)).toBeNull();
+	});
+
+	it('stores and retrieves results', async () => {
+		await cache.write(TASK, RESULT);
+		const stored = await cache.read(TASK);
+
+		expect(stored.cumulativeP).toEqual(RESULT.cumulativeP);
+		expect(stored.normalisation).toEqual(0.999);
+	});
+
+	it('stores results in a single file without temporary files', async () => {
+		await cache.write(TASK, RESULT);
+		const files = await list_dir(path.join(dir, 'store'));
+
+		expect(files.length).toEqual(1);
+		expect(files[0]).toMatch(/\.rcpm$/);
+	});
+
+	it('distinguishes entries by tickets, pCutoff and prizes', async () => {
+		await cache.write(TASK, RESULT);
+
+		expect(await cache.read(Object.assign({}, TASK, {tickets: 3})))
+			.toBeNull();
+
+		expect(await cache.read(Object.assign({}, TASK, {pCutoff: 0})))
+			.toBeNull();
+
+		expect(await cache.read(Object.assign({}, TASK, {
+			prizes: [
+				{count: 1, value: 20},
+				{count: 7, value: 0},
+			],
+		}))).toBeNull();
+	});
+
+	it('distinguishes entries by engine precision', async () => {
+		await cache.write(TASK, RESULT);
+
+		expect(await cache.read(Object.assign({}, TASK, {
+			precision: 'float32',
+		}))).toBeNull();
+
+		expect(await cache.read(Object.assign({}, TASK, {
+			precision: 'float64',
+		}))).not.toBeNull();
+	});
+
+	it('ignores damaged entries', async () => {
+		await cache.write(TASK, RESULT);
+		const [file] = await list_dir(path.join(dir, 'store'));
+		await new Promise((resolve) => {
+			fs.truncate(path.join(dir, 'store', file), 100, resolve);
+		});
+
+		expect(await cache.read(TASK)).toBeNull();
+	});
+
+	it('is used by Raffle to avoid recalculating results', async () => {
+		const engine = {queue_task: jasmine.createSpy('queue_task')};
+		await cache.write(TASK, RESULT);
+
+		const raffle = new Raffle({
+			engine,
+			pCutoff: TASK.pCutoff,
+			prizes: TASK.prizes,
+			store: cache,
+		});
+		const result = await raffle.enter(2);
+
+		expect(engine.queue_task).not.toHaveBeenCalled();
+		expect(result.exact_probability(10)).toEqual(0.25);
+	});
+
+	it('is not shared between engine precisions by Raffle', async () => {
+		const engine = {
+			precision: 'float32',
+			queue_task: jasmine.createSpy('queue_task')
+				.and.returnValue(Promise.resolve(RESULT)),
+		};
+		await cache.write(TASK, RESULT);
+
+		const raffle = new Raffle({
+			engine,
+			pCutoff: TASK.pCutoff,
+			prizes: TASK.prizes,
+			store: cache,
+		});
+		await raffle.enter(2);
+
+		expect(engine.queue_task).toHaveBeenCalled();
+	});
+
+	it('is populated by Raffle when results are calculated', async () => {
+		const engine = {
+			queue_task: jasmine.createSpy('queue_task')
+				.and.returnValue(Promise.resolve(RESULT)),
+		};
+		const store = {
+			read: jasmine.createSpy('read')
+				.and.returnValue(Promise.resolve(null)),
+			write: jasmine.createSpy('write')
+				.and.returnValue(Promise.resolve()),
+		};
+
+		const raffle = new Raffle({engine, prizes: TASK.prizes, store});
+		await raffle.enter(2);
+
+		expect(store.write).toHaveBeenCalledWith(jasmine.anything(), RESULT);
+	});
+});
@@ -0,0 +1,112 @@
+'use strict';
+
+const Moments = require('../src/Moments');
+
+describe('Moments', () => {
+	it('calculates exact moments for sampling without replacement', () => {
+		const prizes = [
+			{count: 1, value: 10},
+			{count: 3, value: 5},
+			{count: 4, value: 0},
+		];
+		const {mean, skewness, variance} = Moments.moments(prizes, 8, 4);
+
+		// Exact p for values 0, 5, 10, 15, 20, 25:
+		// 1/70, 12/70, 22/70, 22/70, 12/70, 1/70
+		expect(mean).toBeNear(12.5, 1e-9);
+		expect(variance).toBeNear(27.6785714, 1e-6);
+		expect(skewness).toBeNear(0, 1e-9);
+	});
+
+	it('calculates skewness', () => {
+		const prizes = [{count: 1, value: 1}, {count: 4, value: 0}];
+		const {mean, skewness, variance} = Moments.moments(prizes, 5, 2);
+
+		// Bernoulli(0.4)
+		expect(mean).toBeNear(0.4, 1e-9);
+		expect(variance).toBeNear(0.24, 1e-9);
+		expect(skewness).toBeNear(0.048 / Math.pow(0.24, 1.5), 1e-9);
+	});
+
+	it('has no variance when every ticket is drawn', () => {
+		const prizes = [{count: 1, value: 10}, {count: 3, value: 5}];
+		const {mean, variance} = Moments.moments(prizes, 4, 4);
+
+		expect(mean).toBeNear(25, 1e-9);
+		expect(variance).toBeNear(0, 1e-9);
+	});
+
+	it('calculates normal quantiles', () => {
+		expect(Moments.normal_quantile(0.5)).toBeNear(0, 1e-9);
+		expect(Moments.normal_quantile(0.975)).toBeNear(1.959964, 1e-6);
+		expect(Moments.normal_quantile(0.01)).toBeNear(-2.326348, 1e-6);
+	});
+
+	it('estimates percentiles within guaranteed bounds', () => {
+		const prizes = [
+			{count: 1, value: 10},
+			{count: 3, value: 5},
+			{count: 4, value: 0},
+		];
+		const estimate = Moments.estimate(prizes, 8, 4, [0, 10, 50, 90, 100]);
+
+		expect(estimate.min).toEqual(0);
+		expect(estimate.max).toEqual(25);
+		expect(estimate.percentiles[0]).toEqual(0);
+		expect(estimate.percentiles[2]).toBeNear(12.5, 1e-6);
+		expect(estimate.percentiles[4]).toEqual(25);
+
+		const exact = [0, 5, 10, 20, 25];
+		for(let i = 0; i < exact.length; ++ i) {
+			const {low, high} = estimate.percentileBounds[i];
+
+			expect(low).not.toBeGreaterThan(exact[i]);
+			expect(high).not.toBeLessThan(exact[i]);
+			expect(estimate.percentiles[i]).not.toBeLessThan(low);
+			expect(estimate.percentiles[i]).not.toBeGreaterThan(high);
+		}
+	});
+
+	it('bounds the probability of reaching a threshold', () => {
+		const prizes = [
+			{count: 1, value: 10},
+			{count: 3, value: 5},
+			{count: 4, value: 0},
+		];
+		// Exact p(value >= x) for 4 tickets (see above)
+		const exact = {0: 1, 1: 69 / 70, 15: 35 / 70, 24: 1 / 70, 26: 0};
+		for(const [x, p] of Object.entries(exact)) {
+			const {low, high} = Moments.probability_bounds(prizes, 8, 4, {
+				threshold: x,
+			});
+
+			expect(low).not.toBeGreaterThan(p);
+			expect(high).not.toBeLessThan(p);
+		}
+
+		const bounds = (threshold) => Moments.probability_bounds(
+			prizes,
+			8,
+			4,
+			{threshold}
+		);
+
+		expect(bounds(0).low).toEqual(1);
+		expect(bounds(26).high).toEqual(0);
+	});
+
+	it('bounds probabilities over several draws', () => {
+		const prizes = [{count: 1, value: 1}, {count: 1, value: 0}];
+
+		const bounds = (tickets, threshold) => Moments.probability_bounds(
+			prizes,
+			2,
+			tickets,
+			{horizon: 2, threshold}
+		);
+
+		expect(bounds(1, 3)).toEqual({high: 0, low: 0});
+		expect(bounds(2, 2)).toEqual({high: 1, low: 1});
+		expect(bounds(1, 2).high).toBeNear(1 / 3, 1e-9);
+	});
+});
@@ -0,0 +1,145 @@
+'use strict';
+
+const path = require('path');
+const {NodeWorkerEngine} = require('../src/NodeWorkerEngine');
+const Raffle = require('../src/Raffle');
+
+function generate_task(tickets = 1) {
+	return {
+		pCutoff: 0,
+		prizes: [
+			{count: 1, value: 1},
+			{count: 7, value: 0},
+		],
+		tickets,
+		type: 'generate',
+	};
+}
+
+const GENERATE_TASK = generate_task();
+
+describe('NodeWorkerEngine', () => {
+	let engine = null;
+
+	afterEach(() => {
+		engine.terminate();
+	});
+
+	it('runs tasks in worker threads', async () => {
+		engine = new NodeWorkerEngine({workers: 2});
+		const result = await engine.queue_task(GENERATE_TASK, [], 20);
+
+		expect(result.type).toEqual('result');
+		expect(Array.from(result.cumulativeP)).toEqual([
+			0.875, 0.875, 0,
+			1.000, 0.125, 1,
+		]);
+	});
+
+	it('can be used as a Raffle engine', async () => {
+		engine = new NodeWorkerEngine({workers: 1});
+		const raffle = new Raffle({
+			engine,
+			prizes: [
+				{count: 1, value: 0},
+				{count: 1, value: 1},
+			],
+		});
+
+		const twoRuns = await (await raffle.enter(1)).pow(2);
+
+		expect(twoRuns.range_probability(1.5, 2.5)).toBeNear(0.25, 1e-6);
+	});
+
+	it('runs engine-side queries', async () => {
+		engine = new NodeWorkerEngine({workers: 1});
+		const raffle = new Raffle({
+			engine,
+			prizes: [
+				{count: 1, value: 0},
+				{count: 1, value: 1},
+			],
+		});
+
+		const summary = await raffle.summary(1);
+
+		expect(summary.mean).toBeNear(0.5, 1e-6);
+	});
+
+	it('loads the float32 build when requested', async () => {
+		engine = new NodeWorkerEngine({
+			measureDeviation: true,
+			precision: 'float32',
+			workers: 1,
+		});
+		const result = await engine.queue_task(GENERATE_TASK, [], 20);
+
+		expect(result.cumulativeP[3]).toBeNear(1, 1e-6);
+		expect(result.cumulativeP[4]).toBeNear(0.125, 1e-6);
+		expect(result.deviation.cumulativeP).toBeLessThan(1e-6);
+	});
+
+	it('runs queued tasks from highest to lowest priority', async () => {
+		engine = new NodeWorkerEngine({workers: 1});
+		await engine.queue_task(GENERATE_TASK, [], 0);
+		const order = [];
+		// Each task must be distinct, else they would share a single run
+		const queue = (priority) => engine
+			.queue_task(generate_task(1 + priority / 5), [], priority)
+			.then(() => order.push(priority));
+
+		await Promise.all([
+			queue(5), // Starts immediately (worker is idle)
+			queue(10),
+			queue(0),
+			queue(30),
+			queue(20),
+		]);
+
+		expect(order).toEqual([5, 30, 20, 10, 0]);
+	});
+
+	it('rejects new tasks once the queue is full', async () => {
+		engine = new NodeWorkerEngine({maxQueue: 1, workers: 1});
+		await engine.queue_task(GENERATE_TASK, [], 0);
+		const first = engine.queue_task(generate_task(2), [], 0);
+		const second = engine.queue_task(generate_task(3), [], 0);
+
+		await expectAsync(engine.queue_task(generate_task(4), [], 0))
+			.toBeRejected();
+
+		expect(engine.queue_length()).toEqual(1);
+		await Promise.all([first, second]);
+	});
+
+	it('runs identical tasks once', async () => {
+		engine = new NodeWorkerEngine({workers: 1});
+		await engine.queue_task(GENERATE_TASK, [], 0);
+		const first = engine.queue_task(generate_task(2), [], 0);
+		const second = engine.queue_task(generate_task(3), [], 0);
+		const duplicate = engine.queue_task(generate_task(3), [], 0);
+
+		expect(engine.queue_length()).toEqual(1);
+		const results = await Promise.all([first, second, duplicate]);
+
+		expect(results[2]).toBe(results[1]);
+	});
+
+	it('rejects tasks if no worker can load', async () => {
+		engine = new NodeWorkerEngine({
+			workerFilePath: path.join(__dirname, 'missing_worker.js'),
+			workers: 2,
+		});
+
+		await expectAsync(engine.queue_task(GENERATE_TASK, [], 0))
+			.toBeRejected();
+	});
+
+	it('rejects outstanding tasks when terminated', async () => {
+		engine = new NodeWorkerEngine({workers: 1});
+		const task = engine.queue_task(GENERATE_TASK, [], 0);
+		engine.terminate();
+
+		await expectAsync(task).toBeRejected();
+	});
+});
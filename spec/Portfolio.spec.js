@@ -0,0 +1,81 @@
+'use strict';
+
+const Portfolio = require('../src/Portfolio');
+const Raffle = require('../src/Raffle');
+
+describe('Portfolio', () => {
+	let worker = null;
+	beforeAll(async () => {
+		worker = await require('../src/raffle_worker');
+	});
+
+	it('combines independent raffles', async () => {
+		const portfolio = new Portfolio([
+			{
+				audience: 4,
+				prizes: [{count: 1, value: 100}],
+				tickets: 2,
+			},
+			{
+				audience: 5,
+				prizes: [{count: 1, value: 50}, {count: 1, value: 25}],
+				tickets: 1,
+			},
+		], {engine: worker.SynchronousEngine});
+
+		const result = await portfolio.enter();
+
+		// Expect p(100) = 1/2; p(50) = 1/5; p(25) = 1/5
+		expect(result.tickets()).toEqual(3);
+		expect(result.values()).toEqual([0, 25, 50, 100, 125, 150]);
+		expect(result.exact_probability(0)).toBeNear(0.3, 1e-9);
+		expect(result.exact_probability(125)).toBeNear(0.1, 1e-9);
+		expect(result.mean()).toBeNear(50 + 15, 1e-9);
+	});
+
+	it('matches repeated entry for identical raffles', async () => {
+		const raffle = new Raffle({
+			audience: 10,
+			engine: worker.SynchronousEngine,
+			prizes: [{count: 2, value: 10}, {count: 1, value: 35}],
+		});
+		const portfolio = new Portfolio([
+			{raffle, tickets: 3},
+			{raffle, tickets: 3},
+		]);
+
+		const combined = await portfolio.enter();
+		const expected = await (await raffle.enter(3)).pow(2);
+
+		expect(combined.values()).toEqual(expected.values());
+		for(const value of expected.values()) {
+			expect(combined.exact_probability(value))
+				.toBeNear(expected.exact_probability(value), 1e-9);
+		}
+	});
+
+	it('calculates each raffle before combining them', async () => {
+		const engine = {
+			queue_task: jasmine.createSpy('queue_task').and.callFake(
+				(trigger) => worker.SynchronousEngine.queue_task(trigger)
+			),
+		};
+		const portfolio = new Portfolio([
+			{prizes: [{count: 1, value: 1}], tickets: 1},
+			{prizes: [{count: 1, value: 2}], tickets: 1},
+		], {engine});
+
+		await portfolio.enter({priority: 5});
+
+		const calls = engine.queue_task.calls.allArgs();
+
+		expect(calls.map(([{type}]) => type))
+			.toEqual(['generate', 'generate', 'portfolio']);
+		expect(calls[2][0].quantum).toEqual(1);
+		expect(calls[2][2]).toEqual(6);
+	});
+
+	it('rejects empty portfolios', () => {
+		expect(() => new Portfolio([])).toThrow();
+	});
+});
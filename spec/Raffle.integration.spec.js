@@ -38,4 +38,187 @@ describe('Raffle Integration', () => {
 		expect(twoRuns.range_probability(1.5, 2.5))
 			.toBeNear(0.25, 1e-6);
 	});
+
+	it('keeps compact results compact when raised to a power', async () => {
+		const raffle = new Raffle({
+			compact: true,
+			engine: worker.SynchronousEngine,
+			prizes: [
+				{count: 1, value: 0},
+				{count: 1, value: 1},
+			],
+		});
+
+		const oneRun = await raffle.enter(1);
+		const twoRuns = await oneRun.pow(2);
+
+		expect(oneRun.dist.encoding).toEqual('compact');
+		expect(twoRuns.dist.encoding).toEqual('compact');
+		expect(twoRuns.range_probability(1.5, 2.5))
+			.toBeNear(0.25, 1e-6);
+	});
+
+	it('keeps compact results compact in a power series', async () => {
+		const raffle = new Raffle({
+			compact: true,
+			engine: worker.SynchronousEngine,
+			prizes: [
+				{count: 1, value: 0},
+				{count: 1, value: 1},
+			],
+		});
+
+		const oneRun = await raffle.enter(1);
+		const [r1, r2, r3] = await oneRun.pow_series(3);
+
+		expect(r1).toBe(oneRun);
+		expect(r2.dist.encoding).toEqual('compact');
+		expect(r3.dist.encoding).toEqual('compact');
+		expect(r3.range_probability(2.5, 3.5)).toBeNear(0.125, 1e-6);
+	});
+
+	it('summarises distributions in the engine', async () => {
+		const raffle = new Raffle({
+			engine: worker.SynchronousEngine,
+			prizes: [
+				{count: 2, value: 0},
+				{count: 1, value: 1},
+				{count: 1, value: 3},
+			],
+		});
+
+		const summary = await raffle.summary(1, {thresholds: [1]});
+
+		expect(summary.min).toEqual(0);
+		expect(summary.max).toEqual(3);
+		expect(summary.mode).toEqual(0);
+		expect(summary.mean).toBeNear(1, 1e-6);
+		expect(summary.variance).toBeNear(1.5, 1e-6);
+		expect(summary.pAtLeast[0]).toBeNear(0.5, 1e-6);
+	});
+
+	it('bins distributions in the engine', async () => {
+		const raffle = new Raffle({
+			engine: worker.SynchronousEngine,
+			prizes: [
+				{count: 2, value: 0},
+				{count: 1, value: 1},
+				{count: 1, value: 3},
+			],
+		});
+
+		const histogram = await raffle.histogram(1, {
+			bins: 4,
+			high: 4,
+			low: 0,
+		});
+
+		expect(histogram.below).toEqual(0);
+		expect(histogram.above).toEqual(0);
+		const level0 = Array.from(histogram.levels[0]);
+		const level1 = Array.from(histogram.levels[1]);
+		[0.5, 0.25, 0, 0.25].forEach((p, i) => {
+			expect(level0[i]).toBeNear(p, 1e-6);
+		});
+		[0.75, 0.25].forEach((p, i) => {
+			expect(level1[i]).toBeNear(p, 1e-6);
+		});
+	});
+
+	it('bounds threshold probabilities in the engine', async () => {
+		const raffle = new Raffle({
+			engine: worker.SynchronousEngine,
+			prizes: [
+				{count: 2, value: 0},
+				{count: 1, value: 1},
+				{count: 1, value: 3},
+			],
+		});
+
+		// 2 tickets: p(total >= 3) = 1 - p(not drawing the 3) = 1 - 3/6
+		const result = await raffle.probability_at_least(2, 3);
+
+		expect(result.error).toBeLessThan(1e-6);
+		expect(result.pAtLeast).toBeNear(0.5, 1e-6);
+	});
+
+	it('finds the minimum holding for a single draw', async () => {
+		const raffle = new Raffle({
+			engine: worker.SynchronousEngine,
+			prizes: [
+				{count: 2, value: 0},
+				{count: 1, value: 1},
+				{count: 1, value: 3},
+			],
+		});
+
+		// 1 ticket: p(total >= 3) = 1/4; 2 tickets: p = 1/2
+		const result = await raffle.minimum_tickets(3, 0.4);
+
+		expect(result.tickets).toEqual(2);
+		expect(result.pAtLeast).toBeNear(0.5, 1e-6);
+	});
+
+	it('finds the minimum holding over several draws', async () => {
+		const raffle = new Raffle({
+			engine: worker.SynchronousEngine,
+			prizes: [
+				{count: 2, value: 0},
+				{count: 1, value: 1},
+				{count: 1, value: 3},
+			],
+		});
+
+		// 1 ticket: p(total >= 4 over 2 draws) = 3/16
+		// 2 tickets: p = 23/36
+		const result = await raffle.minimum_tickets(4, 0.5, {horizon: 2});
+		const two = await (await raffle.enter(2)).pow(2);
+
+		expect(result.tickets).toEqual(2);
+		expect(result.pAtLeast)
+			.toBeNear(two.range_probability(4, Number.POSITIVE_INFINITY), 1e-9);
+	});
+
+	it('compounds winnings into further tickets', async () => {
+		const raffle = new Raffle({
+			engine: worker.SynchronousEngine,
+			prizes: [
+				{count: 1, value: 0},
+				{count: 1, value: 1},
+			],
+		});
+
+		// Winning the first draw buys a second ticket (winning 1 again)
+		const result = await raffle.compound(1, 2, {maxTickets: 2});
+
+		expect(result.values()).toEqual([0, 1, 2]);
+		expect(result.exact_probability(0)).toBeNear(0.25, 1e-6);
+		expect(result.exact_probability(1)).toBeNear(0.25, 1e-6);
+		expect(result.exact_probability(2)).toBeNear(0.5, 1e-6);
+
+		const {hits} = raffle.cache_stats();
+		await raffle.compound(1, 3, {maxTickets: 2});
+
+		expect(raffle.cache_stats().hits).toBeGreaterThan(hits);
+	});
+
+	it('keeps cached results within a memory budget', async () => {
+		const raffle = new Raffle({
+			cacheBytes: 1000,
+			engine: worker.SynchronousEngine,
+			prizes: [
+				{count: 10, value: 1},
+				{count: 5, value: 7},
+				{count: 50, value: 0},
+			],
+		});
+
+		await Promise.all([5, 6, 7, 8, 9, 10].map((n) => raffle.enter(n)));
+		await raffle.enter(5);
+		const stats = raffle.cache_stats();
+
+		expect(stats.bytes).not.toBeGreaterThan(1000);
+		expect(stats.evictions).toBeGreaterThan(0);
+		expect(stats.hits + stats.misses).toEqual(7);
+	});
 });
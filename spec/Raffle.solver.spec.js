@@ -0,0 +1,56 @@
+'use strict';
+
+const Raffle = require('../src/Raffle');
+
+describe('Raffle minimum_tickets', () => {
+	let engine = null;
+	let raffle = null;
+
+	beforeEach(() => {
+		// Single prize; p(value >= 1) = tickets / audience
+		engine = {
+			queue_task: jasmine.createSpy('queue_task')
+				.and.callFake(({tickets}) => Promise.resolve({
+					threshold: {above: tickets / 1000, error: 0},
+				})),
+		};
+		raffle = new Raffle({
+			audience: 1000,
+			engine,
+			prizes: [{count: 1, value: 1}],
+		});
+	});
+
+	it('finds the fewest tickets reaching the target probability', async () => {
+		const result = await raffle.minimum_tickets(1, 0.5);
+
+		expect(result.tickets).toEqual(500);
+		expect(result.pAtLeast).toBeNear(0.5, 1e-9);
+		expect(result.evaluations).toBeLessThan(12);
+		expect(engine.queue_task).toHaveBeenCalledWith(
+			jasmine.objectContaining({threshold: 1, type: 'threshold'}),
+			[],
+			20
+		);
+	});
+
+	it('narrows the search using closed-form bounds', async () => {
+		const result = await raffle.minimum_tickets(1, 0.999);
+
+		expect(result.tickets).toEqual(999);
+		expect(engine.queue_task.calls.count())
+			.toBeLessThan(Math.log2(1000));
+	});
+
+	it('reports impossible targets', async () => {
+		const result = await raffle.minimum_tickets(2, 0.5);
+
+		expect(result.tickets).toBeNull();
+		expect(engine.queue_task).not.toHaveBeenCalled();
+	});
+
+	it('rejects invalid targets', () => {
+		expect(() => raffle.minimum_tickets(1, 0)).toThrow();
+		expect(() => raffle.minimum_tickets(1, 0.5, {horizon: 0})).toThrow();
+	});
+});
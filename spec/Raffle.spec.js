@@ -1,5 +1,6 @@
 'use strict';
 
+const CompactDistribution = require('../src/CompactDistribution');
 const Raffle = require('../src/Raffle');
 
 class SpyEngine {
@@ -131,6 +132,135 @@ describe('Raffle', () => {
 				{cp: 1.0, p: 0.5, value: 1},
 			]));
 		});
+
+		it('retries calculations which failed', async () => {
+			const raffle = new Raffle({audience: 7, engine});
+			engine.queue_task.and.returnValue(Promise.reject(new Error('no')));
+
+			await expectAsync(raffle.enter(2)).toBeRejected();
+			engine.queue_task.and.returnValue(Promise.resolve({
+				cumulativeP: make_cp([{cp: 1, p: 1, value: 0}]),
+			}));
+			const result = await raffle.enter(2);
+
+			expect(result.tickets()).toEqual(2);
+			expect(raffle.cache_stats().entries).toEqual(1);
+		});
+	});
+});
+
+describe('Raffle summary', () => {
+	it('requests a summary from the engine', async () => {
+		const summary = {mean: 1};
+		const engine = new SpyEngine({summary});
+		const raffle = new Raffle({audience: 7, engine});
+		const result = await raffle.summary(2, {
+			percentiles: [50],
+			thresholds: [1],
+		});
+
+		expect(result).toEqual(summary);
+		expect(engine.queue_task).toHaveBeenCalledWith(
+			jasmine.objectContaining({
+				percentiles: [50],
+				thresholds: [1],
+				tickets: 2,
+				type: 'summary',
+			}),
+			[],
+			20
+		);
+	});
+
+	it('summarises existing results without using the engine', async () => {
+		const engine = new SpyEngine({
+			cumulativeP: make_cp([
+				{cp: 0.2, p: 0.2, value: 0},
+				{cp: 0.6, p: 0.4, value: 1},
+				{cp: 1.0, p: 0.4, value: 2},
+			]),
+		});
+		const raffle = new Raffle({audience: 7, engine});
+		await raffle.enter(2);
+		const summary = await raffle.summary(2, {
+			percentiles: [10, 50],
+			thresholds: [1, 3],
+		});
+
+		expect(engine.queue_task).toHaveBeenCalledTimes(1);
+		expect(summary.min).toEqual(0);
+		expect(summary.max).toEqual(2);
+		expect(summary.mean).toBeNear(1.2, 1e-6);
+		expect(summary.variance).toBeNear(0.56, 1e-6);
+		expect(summary.mode).toEqual(2);
+		expect(summary.percentiles).toEqual([0, 1]);
+		expect(summary.pAtLeast[0]).toBeNear(0.8, 1e-6);
+		expect(summary.pAtLeast[1]).toEqual(0);
+	});
+
+	it('rejects more queries than the engine supports', () => {
+		const raffle = new Raffle({audience: 7, engine: new SpyEngine({})});
+		const many = Array.from({length: 33}, (_, i) => i);
+
+		expect(() => raffle.summary(2, {percentiles: many}))
+			.toThrowError(/Too many percentiles: 33/);
+		expect(() => raffle.summary(2, {thresholds: many}))
+			.toThrowError(/Too many thresholds: 33/);
+		expect(() => raffle.summary(2, {percentiles: many.slice(1)}))
+			.not.toThrow();
+	});
+});
+
+describe('Raffle histogram', () => {
+	it('requests a histogram from the engine', async () => {
+		const histogram = {levels: []};
+		const engine = new SpyEngine({histogram});
+		const raffle = new Raffle({audience: 7, engine});
+		const result = await raffle.histogram(2, {
+			bins: 10,
+			high: 50,
+			log: true,
+		});
+
+		expect(result).toEqual(histogram);
+		expect(engine.queue_task).toHaveBeenCalledWith(
+			jasmine.objectContaining({
+				bins: 10,
+				high: 50,
+				log: true,
+				low: 0,
+				tickets: 2,
+				type: 'histogram',
+			}),
+			[],
+			20
+		);
+	});
+
+	it('defaults to a range covering all possible values', async () => {
+		const engine = new SpyEngine({histogram: {}});
+		const raffle = new Raffle({
+			engine,
+			prizes: [
+				{count: 1, value: 100},
+				{count: 2, value: 10},
+				{count: 5, value: 0},
+			],
+		});
+		await raffle.histogram(2);
+
+		expect(engine.queue_task).toHaveBeenCalledWith(
+			jasmine.objectContaining({high: 111, low: 0}),
+			[],
+			20
+		);
+	});
+
+	it('rejects invalid ranges', () => {
+		const raffle = new Raffle({audience: 7, engine: new SpyEngine({})});
+
+		expect(() => raffle.histogram(2, {high: 0, low: 5})).toThrow();
+		expect(() => raffle.histogram(2, {bins: 0})).toThrow();
 	});
 });
 
@@ -246,3 +376,202 @@ describe('Raffle Result', () => {
 		});
 	});
 });
+
+describe('Raffle Result (compact)', () => {
+	let engine = null;
+	let result = null;
+
+	beforeEach(async () => {
+		engine = new SpyEngine({
+			compact: CompactDistribution.encode(make_cp([
+				{cp: 0.2, p: 0.2, value: 0},
+				{cp: 0.6, p: 0.4, value: 10},
+				{cp: 1.0, p: 0.4, value: 20},
+			])),
+		});
+
+		const raffle = new Raffle({audience: 7, compact: true, engine});
+		result = await raffle.enter(2);
+	});
+
+	it('requests compact results from the engine', () => {
+		expect(engine.queue_task).toHaveBeenCalledWith(
+			jasmine.objectContaining({encoding: 'compact'}),
+			[],
+			20
+		);
+	});
+
+	it('reads values directly from the encoding', () => {
+		expect(result.min()).toEqual(0);
+		expect(result.max()).toEqual(20);
+		expect(result.values()).toEqual([0, 10, 20]);
+		expect(result.mean()).toBeNear(12, 1e-6);
+		expect(result.median()).toEqual(10);
+		expect(result.mode()).toEqual(20);
+		expect(result.exact_probability(10)).toBeNear(0.4, 1e-6);
+		expect(result.exact_probability(5)).toEqual(0);
+		expect(result.range_probability(5, 15)).toBeNear(0.4, 1e-6);
+	});
+
+	it('can be expanded to the packed representation', () => {
+		const packed = result.packed();
+
+		expect(packed.length).toEqual(9);
+		expect(packed[4]).toBeNear(0.4, 1e-6);
+		expect(packed[8]).toEqual(20);
+	});
+});
+
+describe('Raffle Result pow_series', () => {
+	let engine = null;
+	let result = null;
+
+	beforeEach(async () => {
+		const raffle = new Raffle({
+			audience: 2,
+			engine: new SpyEngine({
+				cumulativeP: make_cp([
+					{cp: 0.5, p: 0.5, value: 0},
+					{cp: 1.0, p: 0.5, value: 1},
+				]),
+			}),
+		});
+		result = await raffle.enter(1);
+
+		engine = new SpyEngine({
+			series: {
+				cumulativeP: make_cp([
+					{cp: 0.25, p: 0.25, value: 0},
+					{cp: 0.75, p: 0.50, value: 1},
+					{cp: 1.00, p: 0.25, value: 2},
+					{cp: 0.125, p: 0.125, value: 0},
+					{cp: 0.500, p: 0.375, value: 1},
+					{cp: 0.875, p: 0.375, value: 2},
+					{cp: 1.000, p: 0.125, value: 3},
+				]),
+				offsets: Uint32Array.from([0, 3, 7]),
+				powers: [2, 3],
+			},
+		});
+		result.engine = engine;
+	});
+
+	it('requests all powers in a single task', async () => {
+		const series = await result.pow_series(3);
+
+		expect(engine.queue_task).toHaveBeenCalledTimes(1);
+		expect(engine.queue_task).toHaveBeenCalledWith(
+			jasmine.objectContaining({powers: [2, 3], type: 'pow_series'}),
+			[],
+			30
+		);
+		expect(series.length).toEqual(3);
+		expect(series[0]).toBe(result);
+		expect(series[1].values()).toEqual([0, 1, 2]);
+		expect(series[2].values()).toEqual([0, 1, 2, 3]);
+		expect(series[2].mean()).toBeNear(1.5, 1e-6);
+	});
+
+	it('returns results in the requested order', async () => {
+		const series = await result.pow_series([3, 0, 2, 3]);
+
+		expect(series.map((r) => r.max())).toEqual([3, 0, 2, 3]);
+	});
+
+	it('does not use the engine for trivial powers', async () => {
+		const series = await result.pow_series([1, 0]);
+
+		expect(engine.queue_task).not.toHaveBeenCalled();
+		expect(series[0]).toBe(result);
+		expect(series[1].values()).toEqual([0]);
+	});
+
+	it('rejects invalid powers', () => {
+		expect(() => result.pow_series([2, -1])).toThrow();
+		expect(() => result.pow_series([1.5])).toThrow();
+	});
+});
+
+describe('Raffle probability_at_least', () => {
+	it('requests a bounded threshold query from the engine', async () => {
+		const engine = new SpyEngine({
+			threshold: {above: 0.25, below: 0.73, error: 0.02},
+		});
+		const raffle = new Raffle({audience: 7, engine});
+		const result = await raffle.probability_at_least(2, 5, {
+			tolerance: 0.05,
+		});
+
+		expect(result.pAtLeast).toBeNear(0.26, 1e-9);
+		expect(result.error).toBeNear(0.01, 1e-9);
+		expect(engine.queue_task).toHaveBeenCalledWith(
+			jasmine.objectContaining({
+				threshold: 5,
+				tickets: 2,
+				tolerance: 0.05,
+				type: 'threshold',
+			}),
+			[],
+			20
+		);
+	});
+
+	it('uses existing results without using the engine', async () => {
+		const engine = new SpyEngine({
+			cumulativeP: make_cp([
+				{cp: 0.2, p: 0.2, value: 0},
+				{cp: 0.6, p: 0.4, value: 1},
+				{cp: 1.0, p: 0.4, value: 2},
+			]),
+		});
+		const raffle = new Raffle({audience: 7, engine});
+		await raffle.enter(2);
+		const result = await raffle.probability_at_least(2, 1);
+
+		expect(engine.queue_task).toHaveBeenCalledTimes(1);
+		expect(result.pAtLeast).toBeNear(0.8, 1e-6);
+		expect(result.error).toEqual(0);
+	});
+
+	it('rejects invalid tolerances', () => {
+		const raffle = new Raffle({audience: 7, engine: new SpyEngine({})});
+
+		expect(() => raffle.probability_at_least(2, 1, {tolerance: 1}))
+			.toThrow();
+	});
+});
+
+describe('Raffle estimate', () => {
+	it('returns closed-form statistics without using the engine', () => {
+		const engine = new SpyEngine({});
+		const raffle = new Raffle({
+			audience: 8,
+			engine,
+			prizes: [{count: 1, value: 10}, {count: 3, value: 5}],
+		});
+		const estimate = raffle.estimate(4, {percentiles: [50]});
+
+		expect(engine.queue_task).not.toHaveBeenCalled();
+		expect(estimate.mean).toBeNear(12.5, 1e-9);
+		expect(estimate.variance).toBeNear(27.6785714, 1e-6);
+		expect(estimate.percentiles.length).toEqual(1);
+		expect(estimate.percentileBounds.length).toEqual(1);
+	});
+});
+
+describe('Raffle enter', () => {
+	it('raises the priority of pending results when requested again', () => {
+		const engine = new SpyEngine({cumulativeP: make_cp([])});
+		engine.reprioritise = jasmine.createSpy('reprioritise');
+		const raffle = new Raffle({audience: 7, engine});
+		raffle.enter(2, {priority: 5});
+		raffle.enter(2, {priority: 30});
+
+		expect(engine.queue_task).toHaveBeenCalledTimes(1);
+		expect(engine.reprioritise).toHaveBeenCalledWith(
+			jasmine.objectContaining({tickets: 2, type: 'generate'}),
+			30
+		);
+	});
+});
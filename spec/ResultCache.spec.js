@@ -0,0 +1,133 @@
+'use strict';
+
+const ResultCache = require('../src/ResultCache');
+const SharedPromise = require('../src/SharedPromise');
+
+function sized(bytes) {
+	return {byte_length: () => bytes};
+}
+
+function settled() {
+	return new Promise((resolve) => setTimeout(resolve, 0));
+}
+
+describe('ResultCache', () => {
+	let time = 0;
+	let cache = null;
+
+	beforeEach(() => {
+		time = 0;
+		cache = new ResultCache({maxBytes: 100, now: () => time});
+	});
+
+	async function add(key, bytes, cost, {pinned = false} = {}) {
+		let resolve = null;
+		const value = new SharedPromise((res) => {
+			resolve = res;
+		});
+		cache.set(key, value);
+		const release = pinned ? cache.pin([key]) : null;
+		time += cost;
+		resolve(sized(bytes));
+		await settled();
+		return release || value;
+	}
+
+	it('returns stored values and counts hits and misses', async () => {
+		const value = await add('a', 10, 1);
+
+		expect(cache.get('a')).toBe(value);
+		expect(cache.get('b')).toBeUndefined();
+		expect(cache.stats()).toEqual(jasmine.objectContaining({
+			bytes: 10,
+			entries: 1,
+			evictions: 0,
+			hits: 1,
+			misses: 1,
+		}));
+	});
+
+	it('evicts entries once the budget is exceeded', async () => {
+		await add('a', 60, 10);
+		await add('b', 60, 10);
+
+		expect(cache.has('a')).toEqual(false);
+		expect(cache.has('b')).toEqual(true);
+		expect(cache.stats().bytes).toEqual(60);
+		expect(cache.stats().evictions).toEqual(1);
+	});
+
+	it('keeps entries which are expensive to recalculate', async () => {
+		await add('slow', 40, 100);
+		await add('fast', 40, 1);
+		await add('new', 40, 10);
+
+		expect(cache.has('slow')).toEqual(true);
+		expect(cache.has('fast')).toEqual(false);
+		expect(cache.has('new')).toEqual(true);
+	});
+
+	it('eventually evicts expensive entries if unused', async () => {
+		let chain = add('slow', 40, 100);
+		for(let i = 0; i < 20; ++ i) {
+			chain = chain.then(() => add(i, 40, 10)).then(() => cache.get(i));
+		}
+		await chain;
+
+		expect(cache.has('slow')).toEqual(false);
+	});
+
+	it('does not evict pending entries', async () => {
+		const pending = new SharedPromise(() => null);
+		cache.set('pending', pending);
+		await add('a', 200, 1);
+
+		expect(cache.has('pending')).toEqual(true);
+		expect(cache.has('a')).toEqual(false);
+	});
+
+	it('does not evict entries which pending entries depend on', async () => {
+		await add('a', 60, 1);
+		cache.set('b', new SharedPromise(() => null), {dependsOn: ['a']});
+		await add('c', 60, 1);
+
+		expect(cache.has('a')).toEqual(true);
+		expect(cache.has('c')).toEqual(false);
+	});
+
+	it('allows pinned entries to be evicted once released', async () => {
+		const release = await add('a', 60, 1, {pinned: true});
+		await add('b', 60, 10, {pinned: true});
+
+		expect(cache.has('a')).toEqual(true);
+		expect(cache.stats().bytes).toEqual(120);
+
+		release();
+
+		expect(cache.has('a')).toEqual(false);
+		expect(cache.has('b')).toEqual(true);
+	});
+
+	it('removes entries which reject', async () => {
+		const failed = new SharedPromise((resolve, reject) => {
+			reject(new Error('nope'));
+		});
+		cache.set('a', failed);
+		await settled();
+
+		expect(cache.has('a')).toEqual(false);
+		expect(cache.stats().entries).toEqual(0);
+	});
+
+	it('keeps replacements of rejected entries', async () => {
+		let reject = null;
+		cache.set('a', new SharedPromise((res, rej) => {
+			reject = rej;
+		}));
+		const replacement = await add('a', 10, 1);
+		reject(new Error('nope'));
+		await settled();
+
+		expect(cache.get('a')).toBe(replacement);
+	});
+});
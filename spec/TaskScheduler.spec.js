@@ -0,0 +1,204 @@
+'use strict';
+
+const TaskScheduler = require('../src/TaskScheduler');
+
+function make_thread(scheduler) {
+	const thread = {
+		run: jasmine.createSpy('run'),
+	};
+	scheduler.add_thread(thread);
+	scheduler.ready(thread);
+	return thread;
+}
+
+function task(tickets, prizes = [{count: 1, value: 1}]) {
+	return {prizes, tickets, type: 'generate'};
+}
+
+function runs_before(a, b) {
+	if(a.priority !== b.priority) {
+		return a.priority > b.priority;
+	}
+	return a.seq < b.seq;
+}
+
+describe('TaskScheduler', () => {
+	it('runs tasks on idle threads immediately', () => {
+		const scheduler = new TaskScheduler();
+		const thread = make_thread(scheduler);
+		scheduler.queue_task(task(1), [], 10);
+
+		expect(thread.run).toHaveBeenCalledWith(
+			jasmine.objectContaining({trigger: task(1)})
+		);
+		expect(scheduler.queue_length()).toEqual(0);
+	});
+
+	it('runs queued tasks from highest to lowest priority', async () => {
+		const scheduler = new TaskScheduler();
+		const thread = make_thread(scheduler);
+		const order = [];
+		const queue = (priority) => scheduler
+			.queue_task(task(priority), [], priority)
+			.then(() => order.push(priority));
+
+		const all = Promise.all([5, 10, 0, 30, 20, 10].map(queue));
+		while(thread.job) {
+			scheduler.finish(thread, {});
+		}
+		await all;
+
+		expect(order).toEqual([5, 30, 20, 10, 10, 0]);
+	});
+
+	it('shares a single run between identical tasks', async () => {
+		const scheduler = new TaskScheduler();
+		const thread = make_thread(scheduler);
+		const first = scheduler.queue_task(task(1), [], 10);
+		const second = scheduler.queue_task(task(1), [], 10);
+
+		expect(thread.run).toHaveBeenCalledTimes(1);
+		scheduler.finish(thread, {value: 'x'});
+
+		expect(await first).toEqual({value: 'x'});
+		expect(await second).toEqual({value: 'x'});
+	});
+
+	it('does not share tasks which have already finished', async () => {
+		const scheduler = new TaskScheduler();
+		const thread = make_thread(scheduler);
+		const first = scheduler.queue_task(task(1), [], 10);
+		scheduler.finish(thread, {});
+		await first;
+		scheduler.queue_task(task(1), [], 10);
+
+		expect(thread.run).toHaveBeenCalledTimes(2);
+	});
+
+	it('raises the priority of queued tasks', async () => {
+		const scheduler = new TaskScheduler();
+		const thread = make_thread(scheduler);
+		const order = [];
+		const queue = (tickets, priority) => scheduler
+			.queue_task(task(tickets), [], priority)
+			.then(() => order.push(tickets));
+
+		const all = Promise.all([
+			queue(1, 10),
+			queue(2, 10),
+			queue(3, 10),
+			queue(4, 10),
+			queue(4, 20), // Identical to an existing task, but more important
+		]);
+
+		expect(scheduler.reprioritise(task(3), 15)).toBeTrue();
+		expect(scheduler.reprioritise(task(9), 15)).toBeFalse();
+		while(thread.job) {
+			scheduler.finish(thread, {});
+		}
+		await all;
+
+		expect(order).toEqual([1, 4, 4, 3, 2]);
+	});
+
+	it('prefers threads which last ran the same prizes', () => {
+		const scheduler = new TaskScheduler();
+		const thread1 = make_thread(scheduler);
+		const thread2 = make_thread(scheduler);
+		const prizesA = [{count: 1, value: 1}];
+		const prizesB = [{count: 2, value: 1}];
+		scheduler.queue_task(task(1, prizesA), [], 10);
+		scheduler.queue_task(task(1, prizesB), [], 10);
+		scheduler.finish(thread1, {});
+		scheduler.finish(thread2, {});
+
+		scheduler.queue_task(task(2, prizesB), [], 10);
+
+		expect(thread2.run).toHaveBeenCalledTimes(2);
+		expect(thread1.run).toHaveBeenCalledTimes(1);
+	});
+
+	it('prefers queued tasks which match a thread\'s warm caches', () => {
+		const scheduler = new TaskScheduler();
+		const thread = make_thread(scheduler);
+		const prizesA = [{count: 1, value: 1}];
+		const prizesB = [{count: 2, value: 1}];
+		scheduler.queue_task(task(1, prizesA), [], 10);
+		scheduler.queue_task(task(2, prizesB), [], 10);
+		scheduler.queue_task(task(3, prizesA), [], 10);
+		scheduler.queue_task(task(4, prizesA), [], 5);
+		scheduler.finish(thread, {});
+
+		expect(thread.run.calls.mostRecent().args[0].trigger)
+			.toEqual(task(3, prizesA));
+	});
+
+	it('rejects new tasks once the queue is full', async () => {
+		const scheduler = new TaskScheduler({maxQueue: 1});
+		make_thread(scheduler);
+		scheduler.queue_task(task(1), [], 0);
+		scheduler.queue_task(task(2), [], 0);
+
+		await expectAsync(scheduler.queue_task(task(3), [], 0))
+			.toBeRejected();
+	});
+
+	it('rejects outstanding tasks when terminated', async () => {
+		const scheduler = new TaskScheduler();
+		make_thread(scheduler);
+		const running = scheduler.queue_task(task(1), [], 0);
+		const queued = scheduler.queue_task(task(2), [], 0);
+		scheduler.terminate(new Error('Terminated'));
+
+		await expectAsync(running).toBeRejected();
+		await expectAsync(queued).toBeRejected();
+	});
+
+	it('rejects queued tasks if every thread fails to load', async () => {
+		const scheduler = new TaskScheduler();
+		const threads = [{run: () => null}, {run: () => null}];
+		threads.forEach((thread) => scheduler.add_thread(thread));
+		const queued = scheduler.queue_task(task(1), [], 0);
+		const error = new Error('Failed to load');
+
+		expect(scheduler.remove_thread(threads[0], error)).toBeFalse();
+		expect(scheduler.queue_length()).toEqual(1);
+
+		scheduler.remove_thread(threads[1], error);
+
+		await expectAsync(queued).toBeRejectedWith(error);
+		await expectAsync(scheduler.queue_task(task(2), [], 0))
+			.toBeRejectedWith(error);
+		expect(scheduler.queue_length()).toEqual(0);
+	});
+});
+
+describe('PriorityQueue', () => {
+	it('removes items in priority order', () => {
+		const queue = new TaskScheduler.PriorityQueue();
+		const items = [];
+		for(let i = 0; i < 200; ++ i) {
+			const item = {priority: (i * 7919) % 37};
+			items.push(item);
+			queue.push(item);
+		}
+		for(let i = 0; i < 50; ++ i) {
+			queue.remove(items[i * 3]);
+		}
+		for(let i = 1; i < 60; i += 3) {
+			// Not multiples of 3, so still queued
+			items[i].priority += 20;
+			queue.update(items[i]);
+		}
+
+		const order = [];
+		while(queue.length > 0) {
+			order.push(queue.remove(queue.items[0]));
+		}
+
+		expect(order.length).toEqual(150);
+		for(let i = 1; i < order.length; ++ i) {
+			expect(runs_before(order[i - 1], order[i])).toBeTrue();
+		}
+	});
+});
@@ -1,5 +1,7 @@
 'use strict';
 
+const CompactDistribution = require('../src/CompactDistribution');
+
 let worker = null;
 beforeAll(async () => {
 	worker = await require('../src/raffle_worker');
@@ -128,6 +130,38 @@ describe('power', () => {
 	});
 });
 
+describe('pow_series', () => {
+	it('calculates the same results as pow for each power', () => {
+		const pMap = new Map();
+		pMap.set(0, 0.25);
+		pMap.set(1, 0.5);
+		pMap.set(3, 0.25);
+
+		const seen = [];
+		worker.pow_series(pMap, [0, 1, 2, 5, 6, 13], 0, (power, pMapN) => {
+			const expected = worker.pow(pMap, power, 0);
+
+			expect(pMapN.size).toEqual(expected.size);
+			for(const [value, p] of expected.entries()) {
+				expect(pMapN.get(value)).toBeNear(p, 1e-12);
+			}
+			seen.push(power);
+		});
+
+		expect(seen).toEqual([0, 1, 2, 5, 6, 13]);
+	});
+
+	it('does not modify the input map', () => {
+		const pMap = new Map();
+		pMap.set(0, 0.5);
+		pMap.set(1, 0.5);
+
+		worker.pow_series(pMap, [1, 2, 3, 4], 0, () => null);
+
+		expect(Array.from(pMap.entries())).toEqual([[0, 0.5], [1, 0.5]]);
+	});
+});
+
 describe('extract_cumulative_probability', () => {
 	it('creates a cumulative probability array from a map', () => {
 		const pMap = new Map();
@@ -173,6 +207,34 @@ describe('extract_cumulative_probability', () => {
 	});
 });
 
+describe('measure_deviation', () => {
+	it('returns 0 for identical distributions', () => {
+		const cumulativeP = make_cp([
+			{cp: 0.5, p: 0.5, value: 0},
+			{cp: 1.0, p: 0.5, value: 2},
+		]);
+
+		expect(worker.measure_deviation(cumulativeP, cumulativeP))
+			.toEqual({cumulativeP: 0, mean: 0});
+	});
+
+	it('finds the largest difference in cumulative probability', () => {
+		const actual = make_cp([
+			{cp: 0.4, p: 0.4, value: 0},
+			{cp: 1.0, p: 0.6, value: 2},
+		]);
+		const reference = make_cp([
+			{cp: 0.5, p: 0.5, value: 0},
+			{cp: 0.7, p: 0.2, value: 1},
+			{cp: 1.0, p: 0.3, value: 2},
+		]);
+		const deviation = worker.measure_deviation(actual, reference);
+
+		expect(deviation.cumulativeP).toBeNear(0.3, 1e-9);
+		expect(deviation.mean).toBeNear(0.4 / 0.8, 1e-9);
+	});
+});
+
 describe('message_listener', () => {
 	beforeEach(() => {
 		worker.post.fn = jasmine.createSpy('fn');
@@ -204,6 +266,31 @@ describe('message_listener', () => {
 		}, jasmine.anything());
 	});
 
+	it('encodes results compactly if requested', () => {
+		const event = {
+			data: {
+				cumulativeP: make_cp([
+					{cp: 0.5, p: 0.5, value: 0},
+					{cp: 1.0, p: 0.5, value: 10},
+				]),
+				encoding: 'compact',
+				pCutoff: 0,
+				power: 2,
+				type: 'pow',
+			},
+		};
+		worker.message_listener(event);
+
+		const [[{compact}]] = worker.post.fn.calls.allArgs();
+		const dist = new CompactDistribution(compact);
+
+		expect(dist.expand()).toEqual(make_cp([
+			{cp: 0.25, p: 0.25, value: 0},
+			{cp: 0.75, p: 0.50, value: 10},
+			{cp: 1.00, p: 0.25, value: 20},
+		]));
+	});
+
 	it('raises a distribution to a power if called with "pow"', () => {
 		const event = {
 			data: {
@@ -229,6 +316,94 @@ describe('message_listener', () => {
 		}, jasmine.anything());
 	});
 
+	it('packs multiple powers if called with "pow_series"', () => {
+		const event = {
+			data: {
+				cumulativeP: make_cp([
+					{cp: 0.5, p: 0.5, value: 0},
+					{cp: 1.0, p: 0.5, value: 1},
+				]),
+				pCutoff: 0,
+				powers: [3, 2],
+				type: 'pow_series',
+			},
+		};
+		worker.message_listener(event);
+
+		const [[{series}]] = worker.post.fn.calls.allArgs();
+
+		expect(series.powers).toEqual([2, 3]);
+		expect(Array.from(series.offsets)).toEqual([0, 3, 7]);
+		expect(series.cumulativeP).toEqual(make_cp([
+			{cp: 0.250, p: 0.250, value: 0},
+			{cp: 0.750, p: 0.500, value: 1},
+			{cp: 1.000, p: 0.250, value: 2},
+			{cp: 0.125, p: 0.125, value: 0},
+			{cp: 0.500, p: 0.375, value: 1},
+			{cp: 0.875, p: 0.375, value: 2},
+			{cp: 1.000, p: 0.125, value: 3},
+		]));
+	});
+
+	it('encodes each power compactly if requested', () => {
+		const event = {
+			data: {
+				cumulativeP: make_cp([
+					{cp: 0.5, p: 0.5, value: 0},
+					{cp: 1.0, p: 0.5, value: 10},
+				]),
+				encoding: 'compact',
+				pCutoff: 0,
+				powers: [2, 3],
+				type: 'pow_series',
+			},
+		};
+		worker.message_listener(event);
+
+		const [[{series}]] = worker.post.fn.calls.allArgs();
+		const dists = series.compact.map((c) => new CompactDistribution(c));
+
+		expect(dists.map((d) => d.encoding)).toEqual(['compact', 'compact']);
+		expect(dists[0].expand()).toEqual(make_cp([
+			{cp: 0.25, p: 0.25, value: 0},
+			{cp: 0.75, p: 0.50, value: 10},
+			{cp: 1.00, p: 0.25, value: 20},
+		]));
+		expect(dists[1].length).toEqual(4);
+	});
+
+	it('combines independent results if called with "portfolio"', () => {
+		const event = {
+			data: {
+				pCutoff: 0,
+				parts: [
+					make_cp([
+						{cp: 0.5, p: 0.5, value: 0},
+						{cp: 1.0, p: 0.5, value: 10},
+					]),
+					make_cp([
+						{cp: 0.5, p: 0.5, value: 0},
+						{cp: 1.0, p: 0.5, value: 20},
+					]),
+				],
+				quantum: 10,
+				type: 'portfolio',
+			},
+		};
+		worker.message_listener(event);
+
+		expect(worker.post.fn).toHaveBeenCalledWith({
+			cumulativeP: make_cp([
+				{cp: 0.25, p: 0.25, value: 0},
+				{cp: 0.50, p: 0.25, value: 10},
+				{cp: 0.75, p: 0.25, value: 20},
+				{cp: 1.00, p: 0.25, value: 30},
+			]),
+			normalisation: 1,
+			type: 'result',
+		}, jasmine.anything());
+	});
+
 	it('compounds results if called with "compound"', () => {
 		const event = {
 			data: {
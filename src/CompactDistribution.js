@@ -0,0 +1,274 @@
+'use strict';
+
+(() => {
+	/*
+	 * Compact encoding of a cumulative probability map (which would
+	 * otherwise use 3 doubles - cp, p, value - per element):
+	 *
+	 * offset      type       field
+	 *      0      float64    value of first element
+	 *      8      float64    value unit (all values are v0 + k * unit)
+	 *     16      float64    sum of stored p (for normalisation)
+	 *     24      uint32     element count (n)
+	 *     28      uint32     length of value stream (bytes)
+	 *     32      float32[]  p * n
+	 * 32 + 4n     uint8[]    value deltas / unit as unsigned varints
+	 *
+	 * cp is not stored; it is rebuilt as the running sum of p.
+	 */
+
+	const HEADER_BYTES = 32;
+
+	// Elements per index block (random access decodes at most this many)
+	const BLOCK = 32;
+
+	const CP = 0;
+	const P = 1;
+	const VALUE = 2;
+
+	function gcd(a, b) {
+		let x = a;
+		let y = b;
+		while(y) {
+			const t = x % y;
+			x = y;
+			y = t;
+		}
+		return x;
+	}
+
+	function varint_length(x) {
+		let n = 1;
+		for(let v = x; v >= 128; v = Math.floor(v / 128)) {
+			++ n;
+		}
+		return n;
+	}
+
+	function find_unit(cumulativeP) {
+		let unit = 0;
+		for(let i = VALUE + 3; i < cumulativeP.length; i += 3) {
+			const delta = cumulativeP[i] - cumulativeP[i - 3];
+			if(!Number.isSafeInteger(delta) || delta <= 0) {
+				return 0;
+			}
+			unit = gcd(delta, unit);
+		}
+		return unit || 1;
+	}
+
+	function value_steps(cumulativeP, unit) {
+		const steps = [];
+		for(let i = VALUE + 3; i < cumulativeP.length; i += 3) {
+			steps.push((cumulativeP[i] - cumulativeP[i - 3]) / unit);
+		}
+		return steps;
+	}
+
+	function write_varints(stream, values) {
+		let pos = 0;
+		for(let v of values) {
+			for(; v >= 128; v = Math.floor(v / 128)) {
+				stream[pos ++] = (v % 128) + 128;
+			}
+			stream[pos ++] = v;
+		}
+	}
+
+	function encode(cumulativeP, makeBuffer = (n) => new ArrayBuffer(n)) {
+		// Returns null if the values cannot be represented compactly
+		// (e.g. they are not integers)
+		const n = cumulativeP.length / 3;
+		const unit = find_unit(cumulativeP);
+		if(n === 0 || !unit || !Number.isSafeInteger(cumulativeP[VALUE])) {
+			return null;
+		}
+
+		const steps = value_steps(cumulativeP, unit);
+		const streamBytes = steps.reduce((t, v) => t + varint_length(v), 0);
+		const streamOffset = HEADER_BYTES + n * 4;
+		const buffer = makeBuffer(streamOffset + streamBytes);
+
+		const ps = new Float32Array(buffer, HEADER_BYTES, n);
+		let totalP = 0;
+		for(let i = 0; i < n; ++ i) {
+			ps[i] = cumulativeP[i * 3 + P];
+			totalP += ps[i];
+		}
+		new Float64Array(buffer, 0, 3).set([cumulativeP[VALUE], unit, totalP]);
+		new Uint32Array(buffer, 24, 2).set([n, streamBytes]);
+		write_varints(new Uint8Array(buffer, streamOffset, streamBytes), steps);
+
+		return new Uint8Array(buffer);
+	}
+
+	function last_block(starts, fn) {
+		// Binary search for the last block start for which fn is true
+		let p0 = 0;
+		let p1 = starts.length;
+		while(p0 + 1 < p1) {
+			const p = (p0 + p1) >> 1;
+			if(fn(starts[p])) {
+				p0 = p;
+			} else {
+				p1 = p;
+			}
+		}
+		return p0;
+	}
+
+	class CompactDistribution {
+		constructor(bytes) {
+			const {buffer, byteOffset} = bytes;
+			const [v0, unit, totalP] = new Float64Array(buffer, byteOffset, 3);
+			const [n, streamBytes] = new Uint32Array(
+				buffer,
+				byteOffset + 24,
+				2
+			);
+
+			this.bytes = bytes;
+			this.encoding = 'compact';
+			this.v0 = v0;
+			this.unit = unit;
+			this.totalP = totalP;
+			this.length = n;
+			this.ps = new Float32Array(buffer, byteOffset + HEADER_BYTES, n);
+			this.stream = new Uint8Array(
+				buffer,
+				byteOffset + HEADER_BYTES + n * 4,
+				streamBytes
+			);
+			this.index = null;
+		}
+
+		byte_length() {
+			return this.bytes.byteLength;
+		}
+
+		build_index() {
+			// Record the stream position, value and cp at each block start
+			// (so any element can be reached by decoding at most BLOCK)
+			const blocks = Math.ceil(this.length / BLOCK);
+			this.index = {
+				cp: new Float64Array(blocks),
+				pos: new Uint32Array(blocks),
+				value: new Float64Array(blocks),
+			};
+			let cp = 0;
+			this.each_raw(0, this.length, (i, p, value, pos) => {
+				if(i % BLOCK === 0) {
+					const b = i / BLOCK;
+					this.index.cp[b] = cp / this.totalP;
+					this.index.pos[b] = pos;
+					this.index.value[b] = value;
+				}
+				cp += p;
+			});
+			return this.index;
+		}
+
+		each_raw(begin, end, fn) {
+			// Calls fn(index, p, value, streamPos) for elements begin..end-1
+			// (begin must be the start of a block)
+			const b = begin / BLOCK;
+			let pos = b ? this.index.pos[b] : 0;
+			let value = b ? this.index.value[b] : this.v0;
+			for(let i = begin; i < end; ++ i) {
+				if(i > begin) {
+					let delta = 0;
+					let scale = 1;
+					for(let c = 128; c >= 128; scale *= 128) {
+						c = this.stream[pos ++];
+						delta += (c % 128) * scale;
+					}
+					value += delta * this.unit;
+				}
+				fn(i, this.ps[i], value, pos);
+			}
+		}
+
+		each_in_block(b, fn) {
+			// Calls fn(index, cp, value) for every element in block b
+			const begin = b * BLOCK;
+			const norm = 1 / this.totalP;
+			let cp = (this.index || this.build_index()).cp[b];
+			this.each_raw(
+				begin,
+				Math.min(begin + BLOCK, this.length),
+				(i, p, value) => {
+					cp += p * norm;
+					fn(i, cp, value);
+				}
+			);
+		}
+
+		for_each(fn) {
+			// Calls fn({cp, p, value}) for every element in order
+			const norm = 1 / this.totalP;
+			let cp = 0;
+			this.each_raw(0, this.length, (i, p, value) => {
+				cp += p;
+				fn({cp: cp * norm, p: p * norm, value});
+			});
+		}
+
+		read(index, field) {
+			if(field === P) {
+				return this.ps[index] / this.totalP;
+			}
+			let result = 0;
+			this.each_in_block(Math.floor(index / BLOCK), (i, cp, value) => {
+				if(i === index) {
+					result = (field === CP) ? cp : value;
+				}
+			});
+			return result;
+		}
+
+		find_last(field, fn) {
+			// Returns the last index for which fn(field) is true
+			// (the field, cp or value, must be monotonically increasing)
+			const index = this.index || this.build_index();
+			const p0 = last_block((field === CP) ? index.cp : index.value, fn);
+
+			// Block starts record cp *before* their first element
+			// (so the final match may be in the previous block)
+			const b = (field === CP && p0 > 0) ? p0 - 1 : p0;
+			return this.scan_last(b, p0, field, fn);
+		}
+
+		scan_last(firstBlock, lastBlock, field, fn) {
+			let last = firstBlock * BLOCK;
+			for(let b = firstBlock; b <= lastBlock; ++ b) {
+				this.each_in_block(b, (i, cp, value) => {
+					if(fn((field === CP) ? cp : value)) {
+						last = i;
+					}
+				});
+			}
+			return last;
+		}
+
+		expand() {
+			// Returns the equivalent packed {cp, p, value} Float64Array
+			const cumulativeP = new Float64Array(this.length * 3);
+			let x = 0;
+			this.for_each(({cp, p, value}) => {
+				cumulativeP[x] = cp;
+				cumulativeP[x + 1] = p;
+				cumulativeP[x + 2] = value;
+				x += 3;
+			});
+			return cumulativeP;
+		}
+	}
+
+	CompactDistribution.encode = encode;
+
+	if(typeof module === 'object') {
+		module.exports = CompactDistribution;
+	} else {
+		self.CompactDistribution = CompactDistribution;
+	}
+})();
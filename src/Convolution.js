@@ -0,0 +1,145 @@
+'use strict';
+
+(() => {
+	/*
+	 * Combines independent distributions (packed {cp, p, value} elements)
+	 * into the distribution of their sum. Values are first placed on a
+	 * shared axis of multiples of a quantum, which allows the convolution
+	 * to use dense arrays rather than maps. Values which are not exact
+	 * multiples are split between the two nearest points (preserving the
+	 * mean).
+	 */
+
+	const CP = 0;
+	const P = 1;
+	const VALUE = 2;
+
+	function to_grid(value, quantum) {
+		// Position of value on the axis
+		// (snapping rounding errors so that exact multiples are not split)
+		const x = value / quantum;
+		const r = Math.round(x);
+		return (Math.abs(x - r) < 1e-9) ? r : x;
+	}
+
+	class QuantisedDistribution {
+		constructor(offset, data) {
+			this.offset = offset; // Value of data[0] (in quanta)
+			this.data = data; // P for each multiple of the quantum
+		}
+
+		static from_packed(cumulativeP, quantum) {
+			if(cumulativeP.length === 0) {
+				return new QuantisedDistribution(0, new Float64Array(0));
+			}
+			const first = Math.floor(to_grid(cumulativeP[VALUE], quantum));
+			const last = Math.floor(to_grid(
+				cumulativeP[cumulativeP.length - 3 + VALUE],
+				quantum
+			));
+			const data = new Float64Array(last - first + 2);
+			for(let i = 0; i < cumulativeP.length; i += 3) {
+				const pos = to_grid(cumulativeP[i + VALUE], quantum) - first;
+				const index = Math.floor(pos);
+				const frac = pos - index;
+				data[index] += cumulativeP[i + P] * (1 - frac);
+				data[index + 1] += cumulativeP[i + P] * frac;
+			}
+			return new QuantisedDistribution(first, data);
+		}
+
+		nonzero() {
+			const indices = [];
+			for(let i = 0; i < this.data.length; ++ i) {
+				if(this.data[i] > 0) {
+					indices.push(i);
+				}
+			}
+			return indices;
+		}
+
+		convolve(other, pCutoff) {
+			if(!this.data.length || !other.data.length) {
+				return new QuantisedDistribution(0, new Float64Array(0));
+			}
+			const a = this.data;
+			const b = other.data;
+			const bIndices = other.nonzero();
+			const data = new Float64Array(a.length + b.length - 1);
+			for(const i of this.nonzero()) {
+				const pa = a[i];
+				for(const j of bIndices) {
+					const p = pa * b[j];
+					if(p > pCutoff) {
+						data[i + j] += p;
+					}
+				}
+			}
+			return new QuantisedDistribution(this.offset + other.offset, data);
+		}
+
+		to_packed(quantum, pCutoff, make_array) {
+			const indices = this.nonzero()
+				.filter((i) => (this.data[i] > pCutoff));
+
+			let totalP = 0;
+			for(const i of indices) {
+				totalP += this.data[i];
+			}
+
+			// Normalise to [0 1] to correct for numeric errors
+			const cumulativeP = make_array(indices.length * 3);
+			let cp = 0;
+			for(let n = 0; n < indices.length; ++ n) {
+				const x = n * 3;
+				const p = this.data[indices[n]] / totalP;
+				cp += p;
+				cumulativeP[x + CP] = cp;
+				cumulativeP[x + P] = p;
+				cumulativeP[x + VALUE] = (this.offset + indices[n]) * quantum;
+			}
+			return {cumulativeP, totalP};
+		}
+	}
+
+	function convolve_all(parts, {pCutoff = 0, quantum}, make_array) {
+		// Returns {cumulativeP, totalP} for the sum of all parts
+		const combined = parts
+			.map((part) => QuantisedDistribution.from_packed(part, quantum))
+			.reduce((a, b) => a.convolve(b, pCutoff));
+		return combined.to_packed(quantum, pCutoff, make_array);
+	}
+
+	function gcd(a, b) {
+		return b ? gcd(b, a % b) : a;
+	}
+
+	function choose_quantum(values, range, maxBins) {
+		// Uses the largest common unit of the values where possible
+		// (exact quantisation), or a coarser unit if the axis is too long
+		let unit = 0;
+		if(values.every((v) => Number.isInteger(v))) {
+			unit = values.reduce((g, v) => gcd(g, Math.abs(v)), 0);
+		}
+		if(!unit) {
+			return (range > 0) ? range / maxBins : 1;
+		}
+		let quantum = unit;
+		while(range / quantum > maxBins) {
+			quantum *= 2;
+		}
+		return quantum;
+	}
+
+	const Convolution = {
+		QuantisedDistribution,
+		choose_quantum,
+		convolve_all,
+	};
+
+	if(typeof module === 'object') {
+		module.exports = Convolution;
+	} else {
+		self.Convolution = Convolution;
+	}
+})();
@@ -0,0 +1,199 @@
+'use strict';
+
+(() => {
+	const crypto = require('crypto');
+	const fs = require('fs');
+	const path = require('path');
+
+	/*
+	 * Each entry is stored in its own file:
+	 *
+	 * offset  type       field
+	 *      0  uint32     magic ('RCPM')
+	 *      4  uint32     format version
+	 *      8  uint32     engine version
+	 *     12  uint32     tickets
+	 *     16  float64    pCutoff
+	 *     24  uint8[32]  SHA-256 of the prize table
+	 *     56  uint32     byte order marker (0x01020304)
+	 *     60  uint32     encoding (0 = packed, 1 = compact)
+	 *     64  float64    totalP                 \
+	 *     72  uint32     dataLength              | struct CumulativeProbMap
+	 *     76  uint32     (padding)               |
+	 *     80  float64[]  {cp, p, value} * n     /
+	 *
+	 * All values are in native byte order, and the data is 8-byte aligned
+	 * so that it can be memory-mapped and used directly (from JS, the file
+	 * is read into a buffer and viewed as a Float64Array without parsing).
+	 *
+	 * Compact entries store the bytes of a CompactDistribution from offset
+	 * 80 instead, with dataLength holding their length in bytes.
+	 */
+
+	const MAGIC = 0x4D504352;
+	const FORMAT_VERSION = 1;
+	const BYTE_ORDER = 0x01020304;
+
+	// Increment whenever the engine's output changes for the same inputs
+	const ENGINE_VERSION = 3;
+
+	const ENCODINGS = ['packed', 'compact'];
+
+	const HEADER_BYTES = 80;
+	const HASH_OFFSET = 24;
+	const HASH_BYTES = 32;
+
+	function hash_prizes(prizes) {
+		return crypto.createHash('sha256')
+			.update(JSON.stringify(prizes.map(({count, value}) => [
+				count,
+				value,
+			])))
+			.digest();
+	}
+
+	function make_header({prizeHash, tickets, pCutoff}, data, totalP) {
+		const header = new ArrayBuffer(HEADER_BYTES);
+		const encoding = ENCODINGS.indexOf(data.encoding);
+		new Uint32Array(header, 0, 4).set([
+			MAGIC,
+			FORMAT_VERSION,
+			ENGINE_VERSION,
+			tickets,
+		]);
+		new Float64Array(header, 16, 1)[0] = pCutoff;
+		new Uint8Array(header, HASH_OFFSET, HASH_BYTES).set(prizeHash);
+		new Uint32Array(header, 56, 2).set([BYTE_ORDER, encoding]);
+		new Float64Array(header, 64, 1)[0] = totalP;
+		new Uint32Array(header, 72, 1)[0] = data.length;
+		return Buffer.from(header);
+	}
+
+	function data_bytes({encoding, length}) {
+		if(encoding === 'packed') {
+			return length * 3 * Float64Array.BYTES_PER_ELEMENT;
+		}
+		return length;
+	}
+
+	function read_entry(file, key) {
+		if(file.length < HEADER_BYTES) {
+			return null;
+		}
+		// Typed arrays require aligned offsets; copy if the buffer is not
+		const buf = (file.byteOffset % 8)
+			? Buffer.from(new Uint8Array(file).buffer)
+			: file;
+		const {buffer, byteOffset} = buf;
+		const [encoding] = new Uint32Array(buffer, byteOffset + 60, 1);
+		const [totalP] = new Float64Array(buffer, byteOffset + 64, 1);
+		const [length] = new Uint32Array(buffer, byteOffset + 72, 1);
+		const data = {encoding: ENCODINGS[encoding], length};
+		const expected = make_header(key, data, totalP);
+		if(
+			buf.length !== HEADER_BYTES + data_bytes(data)
+			|| !expected.equals(buf.subarray(0, HEADER_BYTES))
+		) {
+			return null;
+		}
+		const view = buf.subarray(HEADER_BYTES);
+		if(data.encoding === 'packed') {
+			return {
+				cumulativeP: new Float64Array(
+					buffer,
+					view.byteOffset,
+					length * 3
+				),
+				normalisation: totalP,
+			};
+		}
+		return {compact: view, normalisation: totalP};
+	}
+
+	function entry_data({compact, cumulativeP}) {
+		if(compact) {
+			return {
+				bytes: compact,
+				encoding: 'compact',
+				length: compact.length,
+			};
+		}
+		return {
+			bytes: cumulativeP,
+			encoding: 'packed',
+			length: cumulativeP.length / 3,
+		};
+	}
+
+	class DiskCache {
+		constructor({dir}) {
+			this.dir = dir;
+		}
+
+		static key({pCutoff, precision = 'float64', prizes, tickets}) {
+			// Precision is the engine build which produced the result
+			return {
+				pCutoff,
+				precision,
+				prizeHash: hash_prizes(prizes),
+				tickets,
+			};
+		}
+
+		file_path({prizeHash, precision, tickets, pCutoff}) {
+			const name = crypto.createHash('sha256')
+				.update(prizeHash)
+				.update(`:${tickets}:${pCutoff}:${precision}:${ENGINE_VERSION}`)
+				.digest('hex');
+			return path.join(this.dir, `${name}.rcpm`);
+		}
+
+		read(task) {
+			const key = DiskCache.key(task);
+			return new Promise((resolve) => {
+				fs.readFile(this.file_path(key), (err, file) => {
+					resolve(err ? null : read_entry(file, key));
+				});
+			});
+		}
+
+		write(task, result) {
+			const key = DiskCache.key(task);
+			const target = this.file_path(key);
+			const temp = `${target}.${process.pid}.tmp`;
+			const entry = entry_data(result);
+			const data = Buffer.concat([
+				make_header(key, entry, result.normalisation),
+				Buffer.from(
+					entry.bytes.buffer,
+					entry.bytes.byteOffset,
+					entry.bytes.byteLength
+				),
+			]);
+
+			return new Promise((resolve, reject) => {
+				fs.mkdir(this.dir, {recursive: true}, (mkErr) => {
+					if(mkErr) {
+						reject(mkErr);
+						return;
+					}
+					// Write to a temporary file then rename it into place
+					// (so readers never see partial entries)
+					fs.writeFile(temp, data, (writeErr) => {
+						if(writeErr) {
+							reject(writeErr);
+							return;
+						}
+						fs.rename(temp, target, (renameErr) => (
+							renameErr ? reject(renameErr) : resolve()
+						));
+					});
+				});
+			});
+		}
+	}
+
+	DiskCache.ENGINE_VERSION = ENGINE_VERSION;
+
+	module.exports = {DiskCache};
+})();
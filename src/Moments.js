@@ -0,0 +1,208 @@
+'use strict';
+
+(() => {
+	/*
+	 * Closed-form statistics of the total value won by a number of
+	 * tickets drawn (without replacement) from a prize table. These need
+	 * O(prizes) work, so can be shown immediately while the full
+	 * distribution is calculated.
+	 */
+
+	function clamp(value, low, high) {
+		return Math.max(Math.min(value, high), low);
+	}
+
+	function greedy_value(prizes, tickets, order) {
+		// Total value from the given number of tickets
+		// (if prizes are won in the given order, e.g. highest value first)
+		let remaining = tickets;
+		let total = 0;
+		for(const {count, value} of prizes.slice().sort(order)) {
+			const n = Math.min(count, remaining);
+			total += n * value;
+			remaining -= n;
+		}
+		return total;
+	}
+
+	function max_value(prizes, tickets) {
+		// Highest possible total value from the given number of tickets
+		return greedy_value(prizes, tickets, (a, b) => (b.value - a.value));
+	}
+
+	function min_value(prizes, tickets) {
+		// Lowest possible total value from the given number of tickets
+		return greedy_value(prizes, tickets, (a, b) => (a.value - b.value));
+	}
+
+	function ticket_moments(prizes, audience) {
+		// Mean and central moments of the value of a single ticket
+		let mean = 0;
+		for(const {count, value} of prizes) {
+			mean += count * value;
+		}
+		mean /= audience;
+
+		let m2 = 0;
+		let m3 = 0;
+		for(const {count, value} of prizes) {
+			const d = value - mean;
+			m2 += count * d * d;
+			m3 += count * d * d * d;
+		}
+		return {m2: m2 / audience, m3: m3 / audience, mean};
+	}
+
+	function moments(prizes, audience, tickets) {
+		// Exact mean, variance and skewness of the total value
+		const n = tickets;
+		const N = audience;
+		const {m2, m3, mean} = ticket_moments(prizes, Math.max(N, 1));
+
+		// Finite population corrections for sampling without replacement
+		const fpc2 = (N > 1) ? (N - n) / (N - 1) : 0;
+		const fpc3 = (N > 2)
+			? ((N - n) * (N - n * 2)) / ((N - 1) * (N - 2))
+			: 0;
+
+		const variance = n * m2 * fpc2;
+		const sd = Math.sqrt(variance);
+		return {
+			mean: n * mean,
+			skewness: (variance > 0) ? (n * m3 * fpc3) / (variance * sd) : 0,
+			variance,
+		};
+	}
+
+	function poly(coeffs, x) {
+		return coeffs.reduce((t, c) => t * x + c, 0);
+	}
+
+	const NQ_A = [
+		-3.969683028665376e+01,
+		2.209460984245205e+02,
+		-2.759285104469687e+02,
+		1.383577518672690e+02,
+		-3.066479806614716e+01,
+		2.506628277459239e+00,
+	];
+	const NQ_B = [
+		-5.447609879822406e+01,
+		1.615858368580409e+02,
+		-1.556989798598866e+02,
+		6.680131188771972e+01,
+		-1.328068155288572e+01,
+		1,
+	];
+	const NQ_C = [
+		-7.784894002430293e-03,
+		-3.223964580411365e-01,
+		-2.400758277161838e+00,
+		-2.549732539343734e+00,
+		4.374664141464968e+00,
+		2.938163982698783e+00,
+	];
+	const NQ_D = [
+		7.784695709041462e-03,
+		3.224671290700398e-01,
+		2.445134137142996e+00,
+		3.754408661907416e+00,
+		1,
+	];
+	const NQ_TAIL = 0.02425;
+
+	function normal_quantile(q) {
+		// Acklam's rational approximation (relative error < 1.15e-9)
+		if(q < NQ_TAIL || q > 1 - NQ_TAIL) {
+			const t = Math.sqrt(-2 * Math.log(Math.min(q, 1 - q)));
+			const z = poly(NQ_C, t) / poly(NQ_D, t);
+			return (q < NQ_TAIL) ? z : -z;
+		}
+		const x = q - 0.5;
+		return poly(NQ_A, x * x) * x / poly(NQ_B, x * x);
+	}
+
+	function cornish_fisher(q, skewness) {
+		// Standardised quantile, corrected for skew
+		const z = normal_quantile(q);
+		return z + (z * z - 1) * skewness / 6;
+	}
+
+	function estimate(prizes, audience, tickets, percentiles) {
+		/*
+		 * Percentiles are Cornish-Fisher approximations. The true
+		 * percentile is guaranteed to be within percentileBounds
+		 * (Cantelli's inequality, which holds for any distribution with
+		 * this mean and variance).
+		 */
+		const {mean, skewness, variance} = moments(prizes, audience, tickets);
+		const sd = Math.sqrt(variance);
+		const min = min_value(prizes, tickets);
+		const max = max_value(prizes, tickets);
+		const at = (w) => clamp(mean + sd * w, min, max);
+
+		const qs = percentiles.map((percent) => clamp(percent * 0.01, 0, 1));
+
+		return {
+			max,
+			mean,
+			min,
+			percentileBounds: qs.map((q) => ({
+				high: (q < 1) ? at(Math.sqrt(q / (1 - q))) : max,
+				low: (q > 0) ? at(-Math.sqrt((1 - q) / q)) : min,
+			})),
+			percentiles: qs.map((q) => {
+				if(q <= 0) {
+					return min;
+				}
+				if(q >= 1) {
+					return max;
+				}
+				return at(cornish_fisher(q, skewness));
+			}),
+			skewness,
+			variance,
+		};
+	}
+
+	function probability_bounds(prizes, audience, tickets, {
+		horizon = 1,
+		threshold,
+	}) {
+		/*
+		 * Returns {low, high} bounding p(total >= threshold), where the
+		 * total is summed over horizon independent draws. Uses the
+		 * possible range and Cantelli's inequality, so is only useful
+		 * away from the median, but needs no distribution.
+		 */
+		if(min_value(prizes, tickets) * horizon >= threshold) {
+			return {high: 1, low: 1};
+		}
+		if(max_value(prizes, tickets) * horizon < threshold) {
+			return {high: 0, low: 0};
+		}
+		const {mean, variance} = moments(prizes, audience, tickets);
+		const d = mean * horizon - threshold;
+		const v = variance * horizon;
+		const tail = v / (v + d * d);
+		if(d > 0) {
+			return {high: 1, low: 1 - tail};
+		}
+		return {high: tail, low: 0};
+	}
+
+	const Moments = {
+		estimate,
+		max_value,
+		min_value,
+		moments,
+		normal_quantile,
+		probability_bounds,
+	};
+
+	if(typeof module === 'object') {
+		module.exports = Moments;
+	} else {
+		window.Moments = Moments;
+	}
+})();
@@ -0,0 +1,93 @@
+'use strict';
+
+(() => {
+	const os = require('os');
+	const path = require('path');
+	const {Worker} = require('worker_threads');
+	const TaskScheduler = require('./TaskScheduler');
+
+	function default_worker_count() {
+		if(typeof os.availableParallelism === 'function') {
+			return os.availableParallelism();
+		}
+		return os.cpus().length || 1;
+	}
+
+	class NodeWorkerEngine {
+		constructor({
+			maxQueue = 10000,
+			measureDeviation = false,
+			precision = 'float64',
+			workerFilePath = path.join(__dirname, 'raffle_worker.js'),
+			workers = default_worker_count(),
+		} = {}) {
+			this.precision = precision;
+			this.workerFilePath = workerFilePath;
+			this.workerData = {measureDeviation, precision, raffleWorker: true};
+			this.scheduler = new TaskScheduler({maxQueue});
+
+			for(let i = 0; i < workers; ++ i) {
+				this.scheduler.add_thread(this.make_thread());
+			}
+		}
+
+		make_thread() {
+			const thread = {
+				run: ({transfer, trigger}) => {
+					thread.worker.ref();
+					thread.worker.postMessage(trigger, transfer);
+				},
+				worker: new Worker(this.workerFilePath, {
+					workerData: this.workerData,
+				}),
+			};
+
+			thread.worker.on('message', (data) => {
+				switch(data.type) {
+				case 'loaded':
+					this.scheduler.ready(thread);
+					break;
+				case 'info':
+					console.log(data.message);
+					break;
+				case 'result':
+					this.scheduler.finish(thread, data);
+					break;
+				}
+				if(thread.job === null) {
+					thread.worker.unref();
+				}
+			});
+
+			thread.worker.on('error', (e) => {
+				if(this.scheduler.remove_thread(thread, e)) {
+					// Replace the failed worker so that the pool stays full
+					this.scheduler.add_thread(this.make_thread());
+				}
+			});
+
+			return thread;
+		}
+
+		queue_task(trigger, transfer, priority) {
+			return this.scheduler.queue_task(trigger, transfer, priority);
+		}
+
+		reprioritise(trigger, priority) {
+			return this.scheduler.reprioritise(trigger, priority);
+		}
+
+		queue_length() {
+			return this.scheduler.queue_length();
+		}
+
+		terminate() {
+			const threads = this.scheduler.terminate(new Error('Terminated'));
+			for(const thread of threads) {
+				thread.worker.terminate();
+			}
+		}
+	}
+
+	module.exports = {NodeWorkerEngine};
+})();
@@ -0,0 +1,51 @@
+'use strict';
+
+(() => {
+	class PackedDistribution {
+		// Wraps a Float64Array of {cp, p, value} elements
+		constructor(data) {
+			this.data = data;
+			this.length = data.length / 3;
+			this.encoding = 'packed';
+		}
+
+		read(index, field) {
+			return this.data[index * 3 + field];
+		}
+
+		find_last(field, fn) {
+			let p0 = 0;
+			let p1 = this.length;
+			while(p0 + 1 < p1) {
+				const p = (p0 + p1) >> 1;
+				if(fn(this.read(p, field))) {
+					p0 = p;
+				} else {
+					p1 = p;
+				}
+			}
+			return p0;
+		}
+
+		for_each(fn) {
+			const {data} = this;
+			for(let x = 0; x < data.length; x += 3) {
+				fn({cp: data[x], p: data[x + 1], value: data[x + 2]});
+			}
+		}
+
+		expand() {
+			return this.data;
+		}
+
+		byte_length() {
+			return this.data.byteLength;
+		}
+	}
+
+	if(typeof module === 'object') {
+		module.exports = PackedDistribution;
+	} else {
+		self.PackedDistribution = PackedDistribution;
+	}
+})();
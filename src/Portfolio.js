@@ -0,0 +1,105 @@
+'use strict';
+
+if(typeof require !== 'function') {
+	window.require = (name) => window[name.replace('./', '')];
+}
+
+(() => {
+	const Convolution = require('./Convolution');
+	const Moments = require('./Moments');
+	const Raffle = require('./Raffle');
+	const Results = require('./Results');
+
+	const {check_integer, read_response} = Results;
+
+	// Largest number of points on the shared value axis
+	// (when choosing a quantum automatically)
+	const MAX_PORTFOLIO_BINS = 1 << 20;
+
+	class Portfolio {
+		/*
+		 * Total winnings from holding tickets in several independent
+		 * raffles. Entries are {raffle, tickets} or {prizes, audience,
+		 * tickets}.
+		 */
+		constructor(entries, {
+			compact = false,
+			engine = null,
+			pCutoff = 0,
+		} = {}) {
+			if(!entries.length) {
+				throw new Error('Portfolio must contain at least one entry');
+			}
+			this.entries = entries.map(({
+				audience = null,
+				prizes = [],
+				raffle = null,
+				tickets,
+			}) => {
+				check_integer('Invalid ticket count', tickets, 0);
+				return {
+					raffle: raffle || new Raffle({
+						audience,
+						engine,
+						pCutoff,
+						prizes,
+					}),
+					tickets,
+				};
+			});
+			this.engine = engine || this.entries[0].raffle.engine;
+			this.encoding = compact ? 'compact' : 'packed';
+			this.pCutoff = pCutoff;
+		}
+
+		tickets() {
+			return this.entries.reduce((n, {tickets}) => n + tickets, 0);
+		}
+
+		quantum() {
+			// Spacing of the shared value axis used to combine the raffles
+			const values = [];
+			let range = 0;
+			for(const {raffle, tickets} of this.entries) {
+				const prizes = raffle.prizes();
+				prizes.forEach(({value}) => values.push(value));
+				range += Moments.max_value(prizes, tickets);
+			}
+			return Convolution.choose_quantum(
+				values,
+				range,
+				MAX_PORTFOLIO_BINS
+			);
+		}
+
+		enter({priority = 20, quantum = null} = {}) {
+			// Raffles are calculated separately, in parallel if possible.
+			// A single 'portfolio' task then combines them in JavaScript
+			// (the convolution does not run in the wasm core)
+			const q = quantum || this.quantum();
+			if(!(q > 0)) {
+				throw new Error(`Invalid quantum: ${q}`);
+			}
+
+			return Promise.all(this.entries.map(({raffle, tickets}) => (
+				raffle.enter(tickets, {priority})
+			))).then((results) => this.engine.queue_task({
+				encoding: this.encoding,
+				pCutoff: this.pCutoff,
+				parts: results.map((r) => r.packed()),
+				quantum: q,
+				type: 'portfolio',
+			}, [], priority + 1)).then((response) => new Results(
+				this.engine,
+				this.tickets(),
+				read_response(response)
+			));
+		}
+	}
+
+	if(typeof module === 'object') {
+		module.exports = Portfolio;
+	} else {
+		window.Portfolio = Portfolio;
+	}
+})();
@@ -5,9 +5,14 @@ if(typeof require !== 'function') {
 }
 
 (() => {
+	const Moments = require('./Moments');
+	const ResultCache = require('./ResultCache');
+	const Results = require('./Results');
 	const SharedPromise = require('./SharedPromise');
 	const {WebWorkerEngine} = require('./WebWorkerEngine');
 
+	const {EMPTY_RESULTS, check_integer, read_response} = Results;
+
 	function accumulate(map, key, value) {
 		if(value > 0) {
 			const existing = map.get(key) || 0;
@@ -15,10 +20,6 @@ if(typeof require !== 'function') {
 		}
 	}
 
-	function clamp(value, low, high) {
-		return Math.max(Math.min(value, high), low);
-	}
-
 	function read_cache(cache, key, genFn) {
 		const r = cache.get(key);
 		if(r) {
@@ -29,24 +30,21 @@ if(typeof require !== 'function') {
 		return generated;
 	}
 
-	function check_integer(
-		message,
-		value,
-		min = Number.NEGATIVE_INFINITY,
-		max = Number.POSITIVE_INFINITY
-	) {
-		if(typeof value !== 'number') {
-			throw new Error(`${message}: "${value}" (must be numeric)`);
-		}
-		if(Math.round(value) !== value) {
-			throw new Error(`${message}: ${value} (must be integer)`);
-		}
-		if(value < min) {
-			throw new Error(`${message}: ${value} (must be >= ${min})`);
+	function compound_key(tickets, power, {maxTickets, ticketCost}) {
+		// Single entries share the cache key used by enter
+		if(power === 1) {
+			return tickets;
 		}
-		if(value > max) {
-			throw new Error(`${message}: ${value} (must be <= ${max})`);
+		return `compound:${maxTickets}:${ticketCost}:${tickets}:${power}`;
+	}
+
+	function highest_cached(cache, power, key) {
+		// Returns the highest power (down to 1) with a cached result
+		let p = power;
+		while(p > 1 && !cache.has(key(p))) {
+			-- p;
 		}
+		return p;
 	}
 
 	function extract_prizemap(prizes, audience) {
@@ -78,174 +76,32 @@ if(typeof require !== 'function') {
 		};
 	}
 
-	const CFIELDS = {
-		cp: 0,
-		p: 1,
-		value: 2,
-	};
-
-	function c_read(data, index, field) {
-		return data[index * 3 + field];
-	}
-
-	function c_data(data, index) {
-		const x = index * 3;
+	function summarise_results(results, percentiles, thresholds) {
+		// Matches the engine's summary task
+		// (used when the full results are already available)
+		const mean = results.mean();
+		let mean2 = 0;
+		results.dist.for_each(({p, value}) => {
+			mean2 += p * value * value;
+		});
 		return {
-			cp: data[x],
-			p: data[x + 1],
-			value: data[x + 2],
+			max: results.max(),
+			mean,
+			min: results.min(),
+			mode: results.mode(),
+			normalisation: 1,
+			pAtLeast: thresholds.map((x) => results.range_probability(
+				x,
+				Number.POSITIVE_INFINITY
+			)),
+			percentiles: percentiles.map((x) => results.percentile(x)),
+			variance: Math.max(mean2 - mean * mean, 0),
 		};
 	}
 
-	function c_find_last_binary(data, field, fn) {
-		let p0 = 0;
-		let p1 = data.length / 3;
-		while(p0 + 1 < p1) {
-			const p = (p0 + p1) >> 1;
-			if(fn(c_read(data, p, field))) {
-				p0 = p;
-			} else {
-				p1 = p;
-			}
-		}
-		return p0;
-	}
-
-	const EMPTY_RESULTS = Float64Array.from([1, 1, 0]);
-
-	class Results {
-		constructor(engine, tickets, cumulativeP) {
-			this.engine = engine;
-			this.n = tickets;
-			this.cumulativeP = cumulativeP;
-			this.qty = this.cumulativeP.length / 3;
-			this.vmin = c_read(this.cumulativeP, 0, CFIELDS.value);
-			this.vmax = c_read(this.cumulativeP, this.qty - 1, CFIELDS.value);
-		}
-
-		tickets() {
-			return this.n;
-		}
-
-		min() {
-			return this.vmin;
-		}
-
-		max() {
-			return this.vmax;
-		}
-
-		values() {
-			const r = [];
-			for(let i = 0; i < this.qty; ++ i) {
-				r.push(c_read(this.cumulativeP, i, CFIELDS.value));
-			}
-			return r;
-		}
-
-		p_below(x) {
-			if(x <= this.vmin) {
-				return 0;
-			}
-			if(x > this.vmax) {
-				return 1;
-			}
-			const index = c_find_last_binary(
-				this.cumulativeP,
-				CFIELDS.value,
-				(value) => (value < x)
-			);
-			return c_read(this.cumulativeP, index, CFIELDS.cp);
-		}
-
-		exact_probability(x) {
-			if(x < this.vmin || x > this.vmax) {
-				return 0;
-			}
-			const index = c_find_last_binary(
-				this.cumulativeP,
-				CFIELDS.value,
-				(value) => (value <= x)
-			);
-			const cur = c_data(this.cumulativeP, index);
-			if(cur.value !== x) {
-				return 0;
-			}
-			return cur.p;
-		}
-
-		range_probability(low, high) {
-			// Returns p(low <= v < high)
-			return clamp(this.p_below(high) - this.p_below(low), 0, 1);
-		}
-
-		percentile(percent) {
-			const frac = percent * 0.01;
-			if(frac <= c_read(this.cumulativeP, 0, CFIELDS.cp)) {
-				return this.vmin;
-			}
-			if(frac >= 1) {
-				return this.vmax;
-			}
-			const index = c_find_last_binary(
-				this.cumulativeP,
-				CFIELDS.cp,
-				(cp) => (cp < frac)
-			) + 1;
-			return c_read(this.cumulativeP, index, CFIELDS.value);
-		}
-
-		mean() {
-			let m = 0;
-			for(let i = 0; i < this.qty; ++ i) {
-				const {p, value} = c_data(this.cumulativeP, i);
-				m += p * value;
-			}
-			return m;
-		}
-
-		median() {
-			return this.percentile(50);
-		}
-
-		mode() {
-			let bestValue = null;
-			let bestP = 0;
-			for(let i = 0; i < this.qty; ++ i) {
-				const p = c_read(this.cumulativeP, i, CFIELDS.p);
-				if(p >= bestP) {
-					bestValue = c_read(this.cumulativeP, i, CFIELDS.value);
-					bestP = p;
-				}
-			}
-			return bestValue;
-		}
-
-		pow(power, {pCutoff = 0, priority = 30} = {}) {
-			check_integer('Invalid power', power, 0);
-
-			if(power === 0) {
-				return Promise.resolve(new Results(
-					this.engine,
-					this.n,
-					EMPTY_RESULTS
-				));
-			} else if(power === 1) {
-				return Promise.resolve(this);
-			}
-
-			return this.engine.queue_task({
-				cumulativeP: this.cumulativeP,
-				pCutoff,
-				power,
-				type: 'pow',
-			}, [], priority).then(({cumulativeP}) => new Results(
-				this.engine,
-				this.n,
-				cumulativeP
-			));
-		}
-	}
+	// Must match wasm/src/options.h
+	const MAX_HISTOGRAM_BINS = 4096;
+	const MAX_SUMMARY_QUERIES = 32;
 
 	let defaultEngine = new WebWorkerEngine();
 
@@ -263,11 +119,16 @@ if(typeof require !== 'function') {
 
 		constructor({
 			audience = null,
+			cacheBytes = Number.POSITIVE_INFINITY,
+			compact = false,
 			engine = null,
 			pCutoff = 0,
 			prizes = [],
+			store = null,
 		}) {
 			this.engine = engine || defaultEngine;
+			this.encoding = compact ? 'compact' : 'packed';
+			this.store = store;
 			this.pCutoff = pCutoff;
 
 			const {fullAudience, prizeMap} = extract_prizemap(prizes, audience);
@@ -279,14 +140,20 @@ if(typeof require !== 'function') {
 				.map(([value, count]) => ({count, value}))
 				.sort((a, b) => (a.count - b.count));
 
-			this.cache = new Map();
-			this.compoundCache = new Map();
+			// Holds results from enter (keyed by ticket count) and compound
+			// (keyed by compound_key)
+			this.cache = new ResultCache({maxBytes: cacheBytes});
 		}
 
 		audience() {
 			return this.m;
 		}
 
+		cache_stats() {
+			// Returns {bytes, entries, evictions, hits, maxBytes, misses}
+			return this.cache.stats();
+		}
+
 		prizes() {
 			return this.rarePrizes.slice();
 		}
@@ -302,26 +169,277 @@ if(typeof require !== 'function') {
 				));
 			}
 
+			if(this.cache.has(tickets) && this.engine.reprioritise) {
+				// The result may still be queued
+				// (make sure it is not waiting behind less important work)
+				this.engine.reprioritise(this.generate_task(tickets), priority);
+			}
+
 			return read_cache(this.cache, tickets, () => (
-				new SharedPromise(this.engine.queue_task({
-					pCutoff: this.pCutoff,
-					prizes: this.rarePrizes,
-					tickets,
-					type: 'generate',
-				}, [], priority).then(({cumulativeP}) => new Results(
-					this.engine,
-					tickets,
-					cumulativeP
-				)))
+				new SharedPromise(this.generate(tickets, priority)
+					.then((response) => new Results(
+						this.engine,
+						tickets,
+						read_response(response)
+					)))
 			)).promise();
 		}
 
+		estimate(tickets, {percentiles = [5, 50, 95]} = {}) {
+			// Returns {min, max, mean, variance, skewness} and the requested
+			// {percentiles, percentileBounds} without using the engine
+			check_integer('Invalid ticket count', tickets, 0, this.m);
+
+			return Moments.estimate(
+				this.rarePrizes,
+				this.m,
+				tickets,
+				percentiles
+			);
+		}
+
+		summary(tickets, {
+			percentiles = [5, 50, 95],
+			priority = 20,
+			thresholds = [],
+		} = {}) {
+			// Returns {min, max, mean, variance, mode, percentiles, pAtLeast}
+			// (without transferring the full distribution from the engine)
+			check_integer('Invalid ticket count', tickets, 0, this.m);
+			check_integer(
+				'Too many percentiles',
+				percentiles.length,
+				0,
+				MAX_SUMMARY_QUERIES
+			);
+			check_integer(
+				'Too many thresholds',
+				thresholds.length,
+				0,
+				MAX_SUMMARY_QUERIES
+			);
+
+			if(tickets === 0 || this.cache.has(tickets)) {
+				return this.enter(tickets).then((results) => (
+					summarise_results(results, percentiles, thresholds)
+				));
+			}
+
+			return this.engine.queue_task({
+				pCutoff: this.pCutoff,
+				percentiles,
+				prizes: this.rarePrizes,
+				thresholds,
+				tickets,
+				type: 'summary',
+			}, [], priority).then(({summary}) => summary);
+		}
+
+		histogram(tickets, {
+			bins = 200,
+			high = null,
+			log = false,
+			low = 0,
+			priority = 20,
+		} = {}) {
+			// Returns {levels, below, above}:
+			// - levels[0] holds p for each of the bins spanning [low high)
+			// - Each subsequent level combines pairs of bins from the last
+			check_integer('Invalid ticket count', tickets, 0, this.m);
+			check_integer('Invalid bin count', bins, 1, MAX_HISTOGRAM_BINS);
+			const highValue = (high === null)
+				? Moments.max_value(this.rarePrizes, tickets) + 1
+				: high;
+			if(!(highValue > low)) {
+				throw new Error(`Invalid histogram range: ${low}-${highValue}`);
+			}
+
+			return this.engine.queue_task({
+				bins,
+				high: highValue,
+				log,
+				low,
+				pCutoff: this.pCutoff,
+				prizes: this.rarePrizes,
+				tickets,
+				type: 'histogram',
+			}, [], priority).then(({histogram}) => histogram);
+		}
+
+		probability_at_least(tickets, threshold, {
+			priority = 20,
+			tolerance = 1e-6,
+		} = {}) {
+			// Returns {pAtLeast, error}, where p(value >= threshold) is in
+			// [pAtLeast - error, pAtLeast + error]
+			// Only elements which could still cross the threshold are tracked
+			// (far cheaper than generating the full distribution)
+			check_integer('Invalid ticket count', tickets, 0, this.m);
+			if(!(tolerance >= 0 && tolerance < 1)) {
+				throw new Error(`Invalid tolerance: ${tolerance}`);
+			}
+
+			if(tickets === 0 || this.cache.has(tickets)) {
+				return this.enter(tickets).then((results) => ({
+					error: 0,
+					pAtLeast: results.range_probability(
+						threshold,
+						Number.POSITIVE_INFINITY
+					),
+				}));
+			}
+
+			return this.engine.queue_task({
+				prizes: this.rarePrizes,
+				threshold,
+				tickets,
+				tolerance,
+				type: 'threshold',
+			}, [], priority).then(({threshold: {above, error}}) => ({
+				error: error * 0.5,
+				pAtLeast: above + error * 0.5,
+			}));
+		}
+
+		probability_over(tickets, threshold, {
+			horizon = 1,
+			priority = 20,
+			tolerance = 1e-6,
+		} = {}) {
+			// Returns p(total >= threshold) over horizon independent draws
+			if(horizon === 1) {
+				return this.probability_at_least(tickets, threshold, {
+					priority,
+					tolerance,
+				}).then(({pAtLeast}) => pAtLeast);
+			}
+			return this.enter(tickets, {priority})
+				.then((results) => results.pow(horizon, {priority}))
+				.then((results) => results.range_probability(
+					threshold,
+					Number.POSITIVE_INFINITY
+				));
+		}
+
+		holding_bracket(threshold, probability, horizon) {
+			// Returns {lo, hi}, where lo tickets certainly fail
+			// (and hi tickets certainly pass, or might if hi is the audience)
+			const last = (fn) => {
+				// Largest ticket count for which fn is true (-1 if none)
+				let p0 = -1;
+				let p1 = this.m + 1;
+				while(p0 + 1 < p1) {
+					const p = Math.floor((p0 + p1) / 2);
+					if(fn(Moments.probability_bounds(
+						this.rarePrizes,
+						this.m,
+						p,
+						{horizon, threshold}
+					))) {
+						p0 = p;
+					} else {
+						p1 = p;
+					}
+				}
+				return p0;
+			};
+
+			return {
+				hi: Math.min(last(({low}) => (low < probability)) + 1, this.m),
+				lo: last(({high}) => (high < probability)),
+			};
+		}
+
+		minimum_tickets(threshold, probability, options = {}) {
+			/*
+			 * Returns {tickets, pAtLeast, evaluations} for the fewest
+			 * tickets which give p(total >= threshold) >= probability over
+			 * options.horizon draws, or {tickets: null} if this is not
+			 * possible. The bracket is narrowed using closed-form bounds
+			 * before bisecting with exact evaluations (which all share the
+			 * engine's cached odds for these prizes).
+			 */
+			const {horizon = 1} = options;
+			check_integer('Invalid horizon', horizon, 1);
+			if(!(probability > 0 && probability <= 1)) {
+				throw new Error(`Invalid probability: ${probability}`);
+			}
+
+			const {hi, lo} = this.holding_bracket(
+				threshold,
+				probability,
+				horizon
+			);
+			const known = new Map();
+			const evaluate = (tickets) => (known.has(tickets)
+				? Promise.resolve(known.get(tickets))
+				: this.probability_over(tickets, threshold, options)
+					.then((p) => known.set(tickets, p).get(tickets)));
+			const done = (tickets) => evaluate(tickets).then((pAtLeast) => ({
+				evaluations: known.size,
+				pAtLeast: (pAtLeast >= probability) ? pAtLeast : 0,
+				tickets: (pAtLeast >= probability) ? tickets : null,
+			}));
+
+			const bisect = (low, high) => {
+				if(low + 1 >= high) {
+					return done(high);
+				}
+				const mid = Math.floor((low + high) / 2);
+				return evaluate(mid).then((p) => ((p >= probability)
+					? bisect(low, mid)
+					: bisect(mid, high)));
+			};
+
+			if(lo >= this.m) {
+				return Promise.resolve({
+					evaluations: 0,
+					pAtLeast: 0,
+					tickets: null,
+				});
+			}
+			return bisect(lo, hi);
+		}
+
+		generate_task(tickets) {
+			return {
+				encoding: this.encoding,
+				pCutoff: this.pCutoff,
+				prizes: this.rarePrizes,
+				tickets,
+				type: 'generate',
+			};
+		}
+
+		generate(tickets, priority) {
+			const task = this.generate_task(tickets);
+			const calculate = () => this.engine.queue_task(task, [], priority);
+
+			if(!this.store) {
+				return calculate();
+			}
+
+			// Results from different engine builds are stored separately
+			const entry = Object.assign({}, task, {
+				precision: this.engine.precision,
+			});
+			return this.store.read(entry).then((stored) => {
+				if(stored) {
+					return stored;
+				}
+				return calculate().then((result) => {
+					// Failing to persist a result does not invalidate it
+					this.store.write(entry, result).catch(() => null);
+					return result;
+				});
+			});
+		}
+
 		compound(tickets, power, {
 			maxTickets = Number.POSITIVE_INFINITY,
 			priority = 10,
 			ticketCost = 1,
 		} = {}) {
-			window.lastMe = this;
 			check_integer('Invalid ticket count', tickets, 0, this.m);
 			check_integer('Invalid power', power, 0);
 
@@ -333,50 +451,55 @@ if(typeof require !== 'function') {
 				));
 			}
 
-			const optCache = read_cache(
-				this.compoundCache,
-				`${maxTickets}:${ticketCost}`,
-				() => new Map()
-			);
-
-			const ticketCache = read_cache(optCache, tickets, () => []);
+			const key = (p) => compound_key(tickets, p, {
+				maxTickets,
+				ticketCost,
+			});
 
 			const step = (res) => {
 				const promises = [];
-				for(let i = 0; i < res.qty; ++ i) {
-					const {p, value} = c_data(res.cumulativeP, i);
-					promises.push(
-						this.enter(
-							Math.min(
-								tickets + Math.floor(value / ticketCost),
-								maxTickets
-							),
-							{priority}
-						).then((r) => ({p, r: r.cumulativeP, value}))
+				const dependencies = [];
+				res.dist.for_each(({p, value}) => {
+					const target = Math.min(
+						tickets + Math.floor(value / ticketCost),
+						maxTickets
 					);
-				}
+					dependencies.push(target);
+					promises.push(this.enter(target, {priority})
+						.then((r) => ({p, r: r.packed(), value})));
+				});
+				const release = this.cache.pin(dependencies);
 
 				return Promise.all(promises)
 					.then((parts) => this.engine.queue_task({
+						encoding: this.encoding,
 						pCutoff: this.pCutoff,
 						parts,
 						type: 'compound',
 					}, [], priority + 1))
-					.then(({cumulativeP}) => new Results(
-						this.engine,
-						tickets,
-						cumulativeP
-					));
+					.then((response) => {
+						release();
+						return new Results(
+							this.engine,
+							tickets,
+							read_response(response)
+						);
+					}, (error) => {
+						release();
+						throw error;
+					});
 			};
 
-			const baseP = Math.min(ticketCache.length + 1, power);
+			const baseP = highest_cached(this.cache, power, key);
 			let promise = (baseP === 1)
 				? this.enter(tickets, {priority})
-				: ticketCache[baseP - 2].promise();
+				: this.cache.get(key(baseP)).promise();
 
 			for(let p = baseP; p < power; ++ p) {
 				const sharedPromise = new SharedPromise(promise.then(step));
-				ticketCache[p - 1] = sharedPromise;
+				this.cache.set(key(p + 1), sharedPromise, {
+					dependsOn: [key(p)],
+				});
 				promise = sharedPromise.promise();
 			}
 			return promise;
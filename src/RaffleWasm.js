@@ -0,0 +1,260 @@
+'use strict';
+
+/* eslint-disable no-underscore-dangle */ // Auto-name-mangling
+
+(() => {
+	// Must match wasm/src/options.h
+	const MAX_SUMMARY_QUERIES = 32;
+
+	const SHARED_BUFFER_AVAILABLE = (
+		typeof SharedArrayBuffer !== 'undefined'
+	);
+
+	function make_shared_buffer(bytes) {
+		return SHARED_BUFFER_AVAILABLE
+			? new SharedArrayBuffer(bytes)
+			: new ArrayBuffer(bytes);
+	}
+
+	function make_shared_float_array(length) {
+		return new Float64Array(
+			make_shared_buffer(length * Float64Array.BYTES_PER_ELEMENT)
+		);
+	}
+
+	function transfer_buffer(buf) {
+		return SHARED_BUFFER_AVAILABLE ? [] : [buf];
+	}
+
+	// Single precision (see PROB_FLOAT32 in wasm/src/options.h) shrinks
+	// ProbMap entries from 16 to 12 bytes, at some cost to accuracy
+	const WASM_SOURCES = {
+		float32: 'wasm/dist/main_f32.wasm',
+		float64: 'wasm/dist/main.wasm',
+	};
+
+	function nodejsReadFile(path) {
+		const fs = require('fs');
+		return new Promise((resolve, reject) => {
+			fs.readFile(path, (err, data) => (
+				err ? reject(err) : resolve(data)
+			));
+		});
+	}
+
+	function compileWASM(source) {
+		if(typeof self !== 'undefined' && typeof fetch === 'function') {
+			return WebAssembly.compileStreaming(fetch(`../${source}`));
+		}
+		const path = require('path');
+		return nodejsReadFile(path.join(__dirname, '..', source))
+			.then((d) => WebAssembly.compile(d));
+	}
+
+	function loadWASM(source) {
+		return compileWASM(source)
+			.then((mod) => WebAssembly.instantiate(mod, {
+				env: {
+					throw_error: () => {
+						console.error('throw_error called');
+						throw new Error();
+					},
+				},
+			}))
+			.then((instance) => {
+				instance.exports.prep();
+
+				function readCumulativeMap(ptr) {
+					const { memory } = instance.exports;
+					const [totalP] = new Float64Array(memory.buffer, ptr, 1);
+					const [length] = new Int32Array(
+						memory.buffer,
+						ptr + Float64Array.BYTES_PER_ELEMENT,
+						1
+					);
+					const dataOut = make_shared_float_array(length * 3);
+					const dataIn = new Float64Array(
+						memory.buffer,
+						ptr + Float64Array.BYTES_PER_ELEMENT * 2,
+						length * 3
+					);
+					for(let i = 0; i < length * 3; ++ i) {
+						dataOut[i] = dataIn[i];
+					}
+					return {
+						cumulativeP: dataOut,
+						totalP,
+					};
+				}
+
+				function readSummary(ptr) {
+					const {buffer} = instance.exports.memory;
+					const doubles = Float64Array.BYTES_PER_ELEMENT;
+					const stats = new Float64Array(buffer, ptr, 6);
+					const [totalP, mean, variance, min, max, mode] = stats;
+					const [nP, nT] = new Uint32Array(
+						buffer,
+						ptr + doubles * 6,
+						2
+					);
+					const pAddr = ptr + doubles * 7;
+					const tAddr = pAddr + doubles * MAX_SUMMARY_QUERIES;
+					return {
+						max,
+						mean,
+						min,
+						mode,
+						normalisation: totalP,
+						pAtLeast: Array.from(
+							new Float64Array(buffer, tAddr, nT)
+						),
+						percentiles: Array.from(
+							new Float64Array(buffer, pAddr, nP)
+						),
+						variance,
+					};
+				}
+
+				function readHistogram(ptr) {
+					const {buffer} = instance.exports.memory;
+					const doubles = Float64Array.BYTES_PER_ELEMENT;
+					const stats = new Float64Array(buffer, ptr, 5);
+					const [totalP, low, high, below, above] = stats;
+					const [bins, levelCount] = new Uint32Array(
+						buffer,
+						ptr + doubles * 5,
+						2
+					);
+					const levels = [];
+					let addr = ptr + doubles * 6;
+					for(let n = bins, i = 0; i < levelCount; ++ i) {
+						const level = make_shared_float_array(n);
+						level.set(new Float64Array(buffer, addr, n));
+						levels.push(level);
+						addr += n * doubles;
+						n = Math.ceil(n / 2);
+					}
+					return {
+						above,
+						below,
+						high,
+						levels,
+						low,
+						normalisation: totalP,
+					};
+				}
+
+				function readThreshold(ptr) {
+					const {buffer} = instance.exports.memory;
+					const [above, below, error] = new Float64Array(
+						buffer,
+						ptr,
+						3
+					);
+					return {above, below, error};
+				}
+
+				function setPrizes(prizes) {
+					instance.exports.reset_prizes();
+					for(const prize of prizes) {
+						instance.exports.add_prize(prize.count, prize.value);
+					}
+				}
+
+				return {
+					calculate_cprobability_map: (
+						prizes,
+						tickets,
+						pCutoff
+					) => {
+						setPrizes(prizes);
+						const ptr = instance.exports.calculate_cprobability_map(
+							tickets,
+							pCutoff
+						);
+						return readCumulativeMap(ptr);
+					},
+					calculate_histogram: (
+						{prizes, tickets, pCutoff},
+						{bins, low, high, log}
+					) => {
+						setPrizes(prizes);
+						const ptr = instance.exports.calculate_histogram(
+							tickets,
+							pCutoff,
+							bins,
+							low,
+							high,
+							log ? 1 : 0
+						);
+						return readHistogram(ptr);
+					},
+					calculate_summary: (
+						{prizes, tickets, pCutoff},
+						percentiles,
+						thresholds
+					) => {
+						setPrizes(prizes);
+						instance.exports.reset_summary_queries();
+						for(const percent of percentiles) {
+							instance.exports.add_percentile_query(percent);
+						}
+						for(const value of thresholds) {
+							instance.exports.add_threshold_query(value);
+						}
+						const ptr = instance.exports.calculate_summary(
+							tickets,
+							pCutoff
+						);
+						return readSummary(ptr);
+					},
+					calculate_threshold: (
+						{prizes, tickets},
+						{threshold, tolerance}
+					) => {
+						setPrizes(prizes);
+						const ptr = instance.exports.calculate_threshold(
+							tickets,
+							threshold,
+							tolerance
+						);
+						return readThreshold(ptr);
+					},
+					odds_cache_stats: () => {
+						const {buffer} = instance.exports.memory;
+						const ptr = instance.exports.get_odds_cache_stats();
+						const [
+							hits,
+							misses,
+							flushes,
+							entries,
+							valuesUsed,
+							valuesCapacity,
+						] = new Float64Array(buffer, ptr, 6);
+						return {
+							entries,
+							flushes,
+							hits,
+							misses,
+							valuesCapacity,
+							valuesUsed,
+						};
+					},
+				};
+			});
+	}
+
+	const RaffleWasm = {
+		WASM_SOURCES,
+		loadWASM,
+		make_shared_buffer,
+		make_shared_float_array,
+		transfer_buffer,
+	};
+
+	if(typeof module === 'object') {
+		module.exports = RaffleWasm;
+	} else {
+		self.RaffleWasm = RaffleWasm;
+	}
+})();
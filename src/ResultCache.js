@@ -0,0 +1,177 @@
+'use strict';
+
+(() => {
+	/*
+	 * Cache of SharedPromises with a byte budget. Once the cache is over
+	 * budget, settled entries are evicted in GreedyDual-Size order: each
+	 * entry is scored by (time taken to calculate) / (bytes held), plus an
+	 * inflation value which rises with each eviction so that entries which
+	 * have not been used recently eventually lose out to newer ones.
+	 *
+	 * Entries which are still pending, or which are pinned (e.g. because a
+	 * pending entry depends on them) are never evicted. Entries which
+	 * reject are removed as soon as they settle.
+	 */
+
+	function default_now() {
+		if(typeof performance === 'object') {
+			return performance.now();
+		}
+		return Date.now();
+	}
+
+	function default_size(value) {
+		return (value && value.byte_length) ? value.byte_length() : 0;
+	}
+
+	class ResultCache {
+		constructor({
+			maxBytes = Number.POSITIVE_INFINITY,
+			now = default_now,
+			sizeOf = default_size,
+		} = {}) {
+			this.maxBytes = maxBytes;
+			this.now = now;
+			this.sizeOf = sizeOf;
+
+			this.entries = new Map();
+			this.inflation = 0;
+			this.bytes = 0;
+			this.hits = 0;
+			this.misses = 0;
+			this.evictions = 0;
+		}
+
+		has(key) {
+			return this.entries.has(key);
+		}
+
+		get(key) {
+			const entry = this.entries.get(key);
+			if(!entry) {
+				++ this.misses;
+				return undefined;
+			}
+			++ this.hits;
+			this.touch(entry);
+			return entry.value;
+		}
+
+		set(key, value, {dependsOn = []} = {}) {
+			// Value is a SharedPromise; its size is recorded once it resolves
+			this.delete(key);
+			const entry = {
+				bytes: 0,
+				cost: 0,
+				key,
+				pins: 0,
+				score: 0,
+				settled: false,
+				start: this.now(),
+				value,
+			};
+			this.entries.set(key, entry);
+			const release = this.pin(dependsOn);
+
+			const settle = (result) => {
+				release();
+				if(this.entries.get(key) !== entry) {
+					return;
+				}
+				entry.settled = true;
+				entry.cost = this.now() - entry.start;
+				entry.bytes = this.sizeOf(result);
+				this.bytes += entry.bytes;
+				this.touch(entry);
+				this.trim();
+			};
+			const forget = () => {
+				// Failures are not cached, so that they can be retried
+				release();
+				if(this.entries.get(key) === entry) {
+					this.delete(key);
+				}
+			};
+			value.promise().then(settle, forget);
+			return this;
+		}
+
+		delete(key) {
+			const entry = this.entries.get(key);
+			if(!entry) {
+				return false;
+			}
+			this.bytes -= entry.bytes;
+			this.entries.delete(key);
+			return true;
+		}
+
+		pin(keys) {
+			// Prevents the given entries from being evicted
+			// (until the returned function is called)
+			const pinned = keys
+				.map((key) => this.entries.get(key))
+				.filter((entry) => entry);
+			pinned.forEach((entry) => ++ entry.pins);
+
+			let released = false;
+			return () => {
+				if(released) {
+					return;
+				}
+				released = true;
+				pinned.forEach((entry) => -- entry.pins);
+				this.trim();
+			};
+		}
+
+		touch(entry) {
+			// Recalculation time saved per byte held
+			const value = entry.cost / Math.max(entry.bytes, 1);
+			entry.score = this.inflation + value;
+		}
+
+		victim() {
+			// Returns the evictable entry with the lowest score (or null)
+			let victim = null;
+			for(const entry of this.entries.values()) {
+				if(
+					entry.settled && !entry.pins &&
+					(!victim || entry.score < victim.score)
+				) {
+					victim = entry;
+				}
+			}
+			return victim;
+		}
+
+		trim() {
+			while(this.bytes > this.maxBytes) {
+				const victim = this.victim();
+				if(!victim) {
+					return;
+				}
+				this.inflation = victim.score;
+				this.delete(victim.key);
+				++ this.evictions;
+			}
+		}
+
+		stats() {
+			return {
+				bytes: this.bytes,
+				entries: this.entries.size,
+				evictions: this.evictions,
+				hits: this.hits,
+				maxBytes: this.maxBytes,
+				misses: this.misses,
+			};
+		}
+	}
+
+	if(typeof module === 'object') {
+		module.exports = ResultCache;
+	} else {
+		window.ResultCache = ResultCache;
+	}
+})();
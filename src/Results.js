@@ -0,0 +1,249 @@
+'use strict';
+
+if(typeof require !== 'function') {
+	window.require = (name) => window[name.replace('./', '')];
+}
+
+(() => {
+	const CompactDistribution = require('./CompactDistribution');
+	const PackedDistribution = require('./PackedDistribution');
+
+	function clamp(value, low, high) {
+		return Math.max(Math.min(value, high), low);
+	}
+
+	function check_integer(
+		message,
+		value,
+		min = Number.NEGATIVE_INFINITY,
+		max = Number.POSITIVE_INFINITY
+	) {
+		if(typeof value !== 'number') {
+			throw new Error(`${message}: "${value}" (must be numeric)`);
+		}
+		if(Math.round(value) !== value) {
+			throw new Error(`${message}: ${value} (must be integer)`);
+		}
+		if(value < min) {
+			throw new Error(`${message}: ${value} (must be >= ${min})`);
+		}
+		if(value > max) {
+			throw new Error(`${message}: ${value} (must be <= ${max})`);
+		}
+	}
+
+	const CFIELDS = {
+		cp: 0,
+		p: 1,
+		value: 2,
+	};
+
+	function make_distribution(data) {
+		if(data instanceof CompactDistribution) {
+			return data;
+		}
+		return new PackedDistribution(data);
+	}
+
+	function read_response({compact, cumulativeP}) {
+		if(compact) {
+			return new CompactDistribution(compact);
+		}
+		return cumulativeP;
+	}
+
+	function read_series({compact = [], cumulativeP, offsets, powers}) {
+		// Maps each power in a 'pow_series' response to its distribution
+		// (compact where the engine could encode it)
+		return new Map(powers.map((power, i) => [power, read_response({
+			compact: compact[i],
+			cumulativeP: cumulativeP.subarray(
+				offsets[i] * 3,
+				offsets[i + 1] * 3
+			),
+		})]));
+	}
+
+	const EMPTY_RESULTS = Float64Array.from([1, 1, 0]);
+
+	class Results {
+		constructor(engine, tickets, data) {
+			// Data is either a Float64Array of {cp, p, value} elements or a
+			// CompactDistribution
+			this.engine = engine;
+			this.n = tickets;
+			this.dist = make_distribution(data);
+			this.cumulativeP = (this.dist.encoding === 'packed') ? data : null;
+			this.qty = this.dist.length;
+			this.vmin = this.dist.read(0, CFIELDS.value);
+			this.vmax = this.dist.read(this.qty - 1, CFIELDS.value);
+		}
+
+		packed() {
+			// Returns the distribution as a Float64Array of {cp, p, value}
+			return this.dist.expand();
+		}
+
+		byte_length() {
+			return this.dist.byte_length();
+		}
+
+		tickets() {
+			return this.n;
+		}
+
+		min() {
+			return this.vmin;
+		}
+
+		max() {
+			return this.vmax;
+		}
+
+		values() {
+			const r = [];
+			this.dist.for_each(({value}) => r.push(value));
+			return r;
+		}
+
+		p_below(x) {
+			if(x <= this.vmin) {
+				return 0;
+			}
+			if(x > this.vmax) {
+				return 1;
+			}
+			const index = this.dist.find_last(
+				CFIELDS.value,
+				(value) => (value < x)
+			);
+			return this.dist.read(index, CFIELDS.cp);
+		}
+
+		exact_probability(x) {
+			if(x < this.vmin || x > this.vmax) {
+				return 0;
+			}
+			const index = this.dist.find_last(
+				CFIELDS.value,
+				(value) => (value <= x)
+			);
+			if(this.dist.read(index, CFIELDS.value) !== x) {
+				return 0;
+			}
+			return this.dist.read(index, CFIELDS.p);
+		}
+
+		range_probability(low, high) {
+			// Returns p(low <= v < high)
+			return clamp(this.p_below(high) - this.p_below(low), 0, 1);
+		}
+
+		percentile(percent) {
+			const frac = percent * 0.01;
+			if(frac <= this.dist.read(0, CFIELDS.cp)) {
+				return this.vmin;
+			}
+			if(frac >= 1) {
+				return this.vmax;
+			}
+			const index = this.dist.find_last(
+				CFIELDS.cp,
+				(cp) => (cp < frac)
+			) + 1;
+			return this.dist.read(index, CFIELDS.value);
+		}
+
+		mean() {
+			let m = 0;
+			this.dist.for_each(({p, value}) => {
+				m += p * value;
+			});
+			return m;
+		}
+
+		median() {
+			return this.percentile(50);
+		}
+
+		mode() {
+			let bestValue = null;
+			let bestP = 0;
+			this.dist.for_each(({p, value}) => {
+				if(p >= bestP) {
+					bestValue = value;
+					bestP = p;
+				}
+			});
+			return bestValue;
+		}
+
+		pow(power, {pCutoff = 0, priority = 30} = {}) {
+			check_integer('Invalid power', power, 0);
+
+			if(power === 0) {
+				return Promise.resolve(new Results(
+					this.engine,
+					this.n,
+					EMPTY_RESULTS
+				));
+			} else if(power === 1) {
+				return Promise.resolve(this);
+			}
+
+			return this.engine.queue_task({
+				cumulativeP: this.packed(),
+				encoding: this.dist.encoding,
+				pCutoff,
+				power,
+				type: 'pow',
+			}, [], priority).then((response) => new Results(
+				this.engine,
+				this.n,
+				read_response(response)
+			));
+		}
+
+		pow_series(powers, {pCutoff = 0, priority = 30} = {}) {
+			// Resolves to a list of Results for each requested power
+			// (or for powers 1..N if given a number), computed in one task
+			// Results use the same encoding as this one, as with pow
+			const list = (typeof powers === 'number')
+				? Array.from({length: powers}, (_, i) => (i + 1))
+				: powers;
+			list.forEach((power) => check_integer('Invalid power', power, 0));
+
+			const remote = Array.from(new Set(list))
+				.filter((power) => (power > 1));
+			const local = (power) => ((power === 0)
+				? new Results(this.engine, this.n, EMPTY_RESULTS)
+				: this);
+			if(!remote.length) {
+				return Promise.resolve(list.map(local));
+			}
+
+			return this.engine.queue_task({
+				cumulativeP: this.packed(),
+				encoding: this.dist.encoding,
+				pCutoff,
+				powers: remote,
+				type: 'pow_series',
+			}, [], priority).then(({series}) => {
+				const found = read_series(series);
+				return list.map((power) => (found.has(power)
+					? new Results(this.engine, this.n, found.get(power))
+					: local(power)));
+			});
+		}
+	}
+
+	Results.EMPTY_RESULTS = EMPTY_RESULTS;
+	Results.check_integer = check_integer;
+	Results.read_response = read_response;
+
+	if(typeof module === 'object') {
+		module.exports = Results;
+	} else {
+		window.Results = Results;
+	}
+})();
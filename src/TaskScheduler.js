@@ -0,0 +1,337 @@
+'use strict';
+
+(() => {
+	// Task types whose triggers are small enough to compare directly
+	// (identical tasks of these types share a single execution)
+	const SHARED_TYPES = new Set([
+		'generate',
+		'histogram',
+		'summary',
+		'threshold',
+	]);
+
+	// Queue entries checked for a task matching an idle thread's caches
+	const AFFINITY_LOOKAHEAD = 7;
+
+	// Marks threads which have not yet finished loading
+	const LOADING = {};
+
+	function default_task_key(trigger) {
+		return SHARED_TYPES.has(trigger.type) ? JSON.stringify(trigger) : null;
+	}
+
+	function default_affinity_key(trigger) {
+		return trigger.prizes ? JSON.stringify(trigger.prizes) : null;
+	}
+
+	function runs_before(a, b) {
+		// Highest priority first, then first-come-first-served
+		if(a.priority !== b.priority) {
+			return a.priority > b.priority;
+		}
+		return a.seq < b.seq;
+	}
+
+	class PriorityQueue {
+		// Binary heap; items record their own position in item.index
+		// (so they can be removed or moved when their priority changes)
+		constructor() {
+			this.items = [];
+			this.seq = 0;
+		}
+
+		get length() {
+			return this.items.length;
+		}
+
+		push(item) {
+			item.seq = (this.seq ++);
+			item.index = this.items.length;
+			this.items.push(item);
+			this.sift_up(item.index);
+		}
+
+		remove(item) {
+			const last = this.items.pop();
+			if(last !== item) {
+				this.place(last, item.index);
+				this.sift_down(this.sift_up(item.index));
+			}
+			item.index = -1;
+			return item;
+		}
+
+		update(item) {
+			this.sift_down(this.sift_up(item.index));
+		}
+
+		place(item, index) {
+			this.items[index] = item;
+			item.index = index;
+		}
+
+		sift_up(index) {
+			const item = this.items[index];
+			let i = index;
+			while(i > 0) {
+				const parent = (i - 1) >> 1;
+				if(!runs_before(item, this.items[parent])) {
+					break;
+				}
+				this.place(this.items[parent], i);
+				i = parent;
+			}
+			this.place(item, i);
+			return i;
+		}
+
+		sift_down(index) {
+			const item = this.items[index];
+			const n = this.items.length;
+			let i = index;
+			for(let c = i * 2 + 1; c < n; c = i * 2 + 1) {
+				if(c + 1 < n && runs_before(this.items[c + 1], this.items[c])) {
+					++ c;
+				}
+				if(!runs_before(this.items[c], item)) {
+					break;
+				}
+				this.place(this.items[c], i);
+				i = c;
+			}
+			this.place(item, i);
+		}
+	}
+
+	class TaskScheduler {
+		/*
+		 * Shared by the worker pool engines. Threads are objects provided by
+		 * the engine with a run({trigger, transfer}) method; the engine
+		 * reports back with ready(), finish() and remove_thread().
+		 */
+		constructor({
+			affinityKey = default_affinity_key,
+			maxQueue = Number.POSITIVE_INFINITY,
+			taskKey = default_task_key,
+		} = {}) {
+			this.affinityKey = affinityKey;
+			this.taskKey = taskKey;
+			this.maxQueue = maxQueue;
+
+			this.queue = new PriorityQueue();
+			this.inFlight = new Map();
+			this.threads = [];
+			this.failure = null;
+		}
+
+		add_thread(thread) {
+			thread.job = LOADING;
+			thread.affinity = null;
+			this.threads.push(thread);
+			this.failure = null;
+		}
+
+		remove_thread(thread, error) {
+			// Returns true if the thread was in use (i.e. had loaded)
+			const i = this.threads.indexOf(thread);
+			if(i !== -1) {
+				this.threads.splice(i, 1);
+			}
+			const {job} = thread;
+			thread.job = null;
+			if(job === LOADING) {
+				if(!this.threads.length) {
+					// No thread is left which could run the queued tasks
+					this.failure = error;
+					this.reject_queued(error);
+				}
+				return false;
+			}
+			if(job) {
+				this.settle(job, ({reject}) => reject(error));
+			}
+			return i !== -1;
+		}
+
+		ready(thread) {
+			this.next(thread);
+		}
+
+		finish(thread, data) {
+			const {job} = thread;
+			this.next(thread);
+			this.settle(job, ({resolve}) => resolve(data));
+		}
+
+		queue_task(trigger, transfer, priority = 0) {
+			return new Promise((resolve, reject) => {
+				const existing = this.find_in_flight(trigger);
+				if(existing) {
+					existing.waiters.push({reject, resolve});
+					this.raise(existing, priority);
+					return;
+				}
+
+				this.add_job({
+					affinity: this.affinityKey(trigger),
+					index: -1,
+					key: this.taskKey(trigger),
+					priority,
+					seq: 0,
+					transfer,
+					trigger,
+					waiters: [{reject, resolve}],
+				});
+			});
+		}
+
+		reprioritise(trigger, priority) {
+			// Raises the priority of an identical queued task
+			// (returns false if there is no such task)
+			const job = this.find_in_flight(trigger);
+			if(!job) {
+				return false;
+			}
+			this.raise(job, priority);
+			return true;
+		}
+
+		queue_length() {
+			return this.queue.length;
+		}
+
+		terminate(error) {
+			// Rejects all outstanding tasks and returns the removed threads
+			this.reject_queued(error);
+
+			const {threads} = this;
+			this.threads = [];
+			for(const thread of threads) {
+				this.remove_thread(thread, error);
+			}
+			return threads;
+		}
+
+		find_in_flight(trigger) {
+			// Returns the queued or running job for an identical task
+			const key = this.taskKey(trigger);
+			return (key === null) ? null : this.inFlight.get(key);
+		}
+
+		queue_error() {
+			if(this.failure) {
+				return this.failure;
+			}
+			if(this.queue.length >= this.maxQueue) {
+				return new Error(`Task queue is full (${this.maxQueue})`);
+			}
+			return null;
+		}
+
+		add_job(job) {
+			const thread = this.idle_thread(job.affinity);
+			const error = thread ? null : this.queue_error();
+			if(error) {
+				this.settle(job, ({reject}) => reject(error));
+				return;
+			}
+			if(job.key !== null) {
+				this.inFlight.set(job.key, job);
+			}
+			if(thread) {
+				this.start(thread, job);
+			} else {
+				this.queue.push(job);
+			}
+		}
+
+		reject_queued(error) {
+			const {items} = this.queue;
+			this.queue = new PriorityQueue();
+			for(const job of items) {
+				this.settle(job, ({reject}) => reject(error));
+			}
+		}
+
+		raise(job, priority) {
+			if(priority > job.priority) {
+				job.priority = priority;
+				if(job.index !== -1) {
+					this.queue.update(job);
+				}
+			}
+		}
+
+		settle(job, fn) {
+			if(job.key !== null && this.inFlight.get(job.key) === job) {
+				this.inFlight.delete(job.key);
+			}
+			job.waiters.forEach(fn);
+		}
+
+		idle_thread(affinity) {
+			let fallback = null;
+			for(const thread of this.threads) {
+				if(thread.job === null) {
+					if(affinity !== null && thread.affinity === affinity) {
+						return thread;
+					}
+					fallback = fallback || thread;
+				}
+			}
+			return fallback;
+		}
+
+		warm_job(affinity, top) {
+			// Earliest job at top's priority which can reuse the caches
+			// (only the first few entries of the heap are checked)
+			const {items} = this.queue;
+			const n = Math.min(items.length, AFFINITY_LOOKAHEAD + 1);
+			let best = null;
+			for(let i = 1; i < n; ++ i) {
+				const job = items[i];
+				if(
+					job.priority === top.priority &&
+					job.affinity === affinity &&
+					(!best || job.seq < best.seq)
+				) {
+					best = job;
+				}
+			}
+			return best;
+		}
+
+		pick_job(thread) {
+			const top = this.queue.items[0];
+			const {affinity} = thread;
+			const warm = (affinity !== null && top.affinity !== affinity)
+				? this.warm_job(affinity, top)
+				: null;
+			return this.queue.remove(warm || top);
+		}
+
+		next(thread) {
+			if(this.queue.length > 0) {
+				this.start(thread, this.pick_job(thread));
+			} else {
+				thread.job = null;
+			}
+		}
+
+		start(thread, job) {
+			thread.job = job;
+			if(job.affinity !== null) {
+				thread.affinity = job.affinity;
+			}
+			thread.run(job);
+		}
+	}
+
+	TaskScheduler.PriorityQueue = PriorityQueue;
+
+	if(typeof module === 'object') {
+		module.exports = TaskScheduler;
+	} else {
+		window.TaskScheduler = TaskScheduler;
+	}
+})();
@@ -5,18 +5,19 @@ if(typeof require !== 'function') {
 }
 
 (() => {
-	function find_last_binary(l, fn) {
-		let p0 = 0;
-		let p1 = l.length;
-		while(p0 + 1 < p1) {
-			const p = (p0 + p1) >> 1;
-			if(fn(l[p])) {
-				p0 = p;
-			} else {
-				p1 = p;
-			}
+	const TaskScheduler = require('./TaskScheduler');
+
+	function worker_path({
+		basePath = 'src',
+		measureDeviation = false,
+		precision = 'float64',
+	}) {
+		// Options are passed to the worker in the query string
+		const params = [`precision=${precision}`];
+		if(measureDeviation) {
+			params.push('measureDeviation');
 		}
-		return p0;
+		return `${basePath}/raffle_worker.js?${params.join('&')}`;
 	}
 
 	function worker_fn(callback) {
@@ -36,8 +37,9 @@ if(typeof require !== 'function') {
 	}
 
 	class WebWorkerEngine {
-		constructor({basePath = 'src'} = {}) {
-			this.workerFilePath = `${basePath}/raffle_worker.js`;
+		constructor(options = {}) {
+			this.precision = options.precision || 'float64';
+			this.workerFilePath = worker_path(options);
 		}
 
 		queue_task(trigger, transfer) {
@@ -56,76 +58,43 @@ if(typeof require !== 'function') {
 	}
 
 	class SharedWebWorkerEngine {
-		constructor({basePath = 'src', workers = 4} = {}) {
-			const workerFilePath = `${basePath}/raffle_worker.js`;
+		constructor(options = {}) {
+			const {workers = 4} = options;
+			const workerFilePath = worker_path(options);
 
-			this.queue = [];
-			this.threads = [];
+			this.precision = options.precision || 'float64';
+			this.scheduler = new TaskScheduler();
 			for(let i = 0; i < workers; ++ i) {
 				const thread = {
-					reject: null,
-					resolve: 1, // Initial loading marker
-					run: ({reject, resolve, transfer, trigger}) => {
-						thread.reject = reject;
-						thread.resolve = resolve;
+					run: ({transfer, trigger}) => {
 						thread.worker.postMessage(trigger, transfer);
 					},
 					worker: new Worker(workerFilePath),
 				};
 				thread.worker.addEventListener('message', worker_fn((r, d) => {
-					const fn = thread.resolve;
-					if(this.queue.length > 0) {
-						thread.run(this.queue.shift());
-					} else {
-						thread.reject = null;
-						thread.resolve = null;
-					}
 					if(r) {
-						fn(d);
+						this.scheduler.finish(thread, d);
+					} else {
+						this.scheduler.ready(thread);
 					}
 				}));
-				this.threads.push(thread);
+				this.scheduler.add_thread(thread);
 			}
 		}
 
 		queue_task(trigger, transfer, priority) {
-			return new Promise((resolve, reject) => {
-				for(const thread of this.threads) {
-					if(thread.resolve === null) {
-						thread.run({reject, resolve, transfer, trigger});
-						return;
-					}
-				}
-				const o = {priority, reject, resolve, transfer, trigger};
-				if(priority === 0) {
-					this.queue.push(o);
-				} else {
-					const i = find_last_binary(
-						this.queue,
-						(x) => (x.priority >= priority)
-					);
-					this.queue.splice(i, 0, o);
-				}
-			});
+			return this.scheduler.queue_task(trigger, transfer, priority);
 		}
 
-		terminate() {
-			for(const {reject} of this.queue) {
-				if(reject !== null) {
-					reject('Terminated');
-				}
-			}
-			this.queue.length = 0;
+		reprioritise(trigger, priority) {
+			return this.scheduler.reprioritise(trigger, priority);
+		}
 
-			for(const thread of this.threads) {
-				if(thread.reject !== null) {
-					thread.reject('Terminated');
-					thread.reject = null;
-					thread.resolve = null;
-					thread.worker.terminate();
-				}
+		terminate() {
+			const threads = this.scheduler.terminate(new Error('Terminated'));
+			for(const thread of threads) {
+				thread.worker.terminate();
 			}
-			this.threads.length = 0;
 		}
 	}
 
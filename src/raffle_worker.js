@@ -2,92 +2,213 @@
 
 /* eslint-disable no-underscore-dangle */ // Auto-name-mangling
 
-const SHARED_BUFFER_AVAILABLE = (typeof SharedArrayBuffer !== 'undefined');
+function load_script(name) {
+	if(typeof require === 'function') {
+		return require(`./${name}`);
+	}
+	self.importScripts(`${name}.js`);
+	return self[name];
+}
 
-function make_shared_float_array(length) {
-	const bytes = length * Float64Array.BYTES_PER_ELEMENT;
-	return new Float64Array(
-		SHARED_BUFFER_AVAILABLE ? new SharedArrayBuffer(bytes) : length
-	);
+const CompactDistribution = load_script('CompactDistribution');
+const Convolution = load_script('Convolution');
+const {
+	WASM_SOURCES,
+	loadWASM,
+	make_shared_buffer,
+	make_shared_float_array,
+	transfer_buffer,
+} = load_script('RaffleWasm');
+
+function worker_options() {
+	// Options given when the worker was created
+	// (in the script's query string for browsers, or workerData for Node.js)
+	let params = {};
+	if(typeof self !== 'undefined' && self.location) {
+		const search = new URLSearchParams(self.location.search);
+		params = {
+			measureDeviation: search.has('measureDeviation'),
+			precision: search.get('precision'),
+		};
+	} else if(typeof require === 'function') {
+		params = require('worker_threads').workerData || {};
+	}
+	return {
+		measureDeviation: Boolean(params.measureDeviation),
+		precision: (params.precision in WASM_SOURCES)
+			? params.precision
+			: 'float64',
+	};
 }
 
-function transfer_buffer(buf) {
-	return SHARED_BUFFER_AVAILABLE ? [] : [buf];
+function deviation_cursor(data) {
+	return {cp: 0, data, i: 0, mean: 0};
 }
 
-function nodejsReadFile(path) {
-	const fs = require('fs');
-	return new Promise((resolve, reject) => {
-		fs.readFile(path, (err, data) => (err ? reject(err) : resolve(data)));
-	});
+function cursor_value({data, i}) {
+	const VALUE = 2;
+	return (i < data.length) ? data[i + VALUE] : Infinity;
 }
 
-function compileWASM(source) {
-	if(typeof fetch === 'function') {
-		return WebAssembly.compileStreaming(fetch(`../${source}`));
+function advance_cursor(cursor, value) {
+	// Steps past the cursor's element if it is at value
+	const CP = 0;
+	const P = 1;
+
+	if(cursor_value(cursor) === value) {
+		cursor.cp = cursor.data[cursor.i + CP];
+		cursor.mean += cursor.data[cursor.i + P] * value;
+		cursor.i += 3;
 	}
-	return nodejsReadFile(`./${source}`).then((d) => WebAssembly.compile(d));
 }
 
-function loadWASM() {
-	return compileWASM('wasm/dist/main.wasm')
-		.then((mod) => WebAssembly.instantiate(mod, {
-			env: {
-				throw_error: () => {
-					console.error('throw_error called');
-					throw new Error();
-				},
-			},
-		}))
-		.then((instance) => {
-			instance.exports.prep();
-
-			function readCumulativeMap(ptr) {
-				const { memory } = instance.exports;
-				const [totalP] = new Float64Array(memory.buffer, ptr, 1);
-				const [length] = new Int32Array(
-					memory.buffer,
-					ptr + Float64Array.BYTES_PER_ELEMENT,
-					1
-				);
-				const dataOut = make_shared_float_array(length * 3);
-				const dataIn = new Float64Array(
-					memory.buffer,
-					ptr + Float64Array.BYTES_PER_ELEMENT * 2,
-					length * 3
-				);
-				for(let i = 0; i < length * 3; ++ i) {
-					dataOut[i] = dataIn[i];
-				}
-				return {
-					cumulativeP: dataOut,
-					totalP,
-				};
-			}
+function measure_deviation(actual, reference) {
+	// Returns the largest difference in cumulative probability at any value
+	// (Kolmogorov-Smirnov distance), and the relative difference in means
+	const a = deviation_cursor(actual);
+	const b = deviation_cursor(reference);
+	let maxCP = 0;
+	while(a.i < actual.length || b.i < reference.length) {
+		const value = Math.min(cursor_value(a), cursor_value(b));
+		advance_cursor(a, value);
+		advance_cursor(b, value);
+		maxCP = Math.max(maxCP, Math.abs(a.cp - b.cp));
+	}
+	return {
+		cumulativeP: maxCP,
+		mean: b.mean ? Math.abs(a.mean - b.mean) / b.mean : Math.abs(a.mean),
+	};
+}
 
+function package_result({cumulativeP, deviation, totalP}, encoding) {
+	const extra = deviation ? {deviation} : {};
+	if(encoding === 'compact') {
+		const compact = CompactDistribution.encode(
+			cumulativeP,
+			make_shared_buffer
+		);
+		if(compact) {
 			return {
-				calculate_cprobability_map: (
-					prizes,
-					tickets,
-					pCutoff
-				) => {
-					instance.exports.reset_prizes();
-					for(const prize of prizes) {
-						instance.exports.add_prize(prize.count, prize.value);
-					}
-					const ptr = instance.exports.calculate_cprobability_map(
-						tickets,
-						pCutoff
-					);
-					return readCumulativeMap(ptr);
-				},
+				result: Object.assign({
+					compact,
+					normalisation: totalP,
+					type: 'result',
+				}, extra),
+				transfer: transfer_buffer(compact.buffer),
 			};
-		});
+		}
+	}
+
+	return {
+		result: Object.assign({
+			cumulativeP,
+			normalisation: totalP,
+			type: 'result',
+		}, extra),
+		transfer: transfer_buffer(cumulativeP.buffer),
+	};
+}
+
+function package_summary(summary) {
+	return {result: {summary, type: 'result'}, transfer: []};
+}
+
+function package_histogram(histogram) {
+	const transfer = [];
+	for(const level of histogram.levels) {
+		transfer.push(...transfer_buffer(level.buffer));
+	}
+	return {result: {histogram, type: 'result'}, transfer};
+}
+
+function package_series(series, encoding) {
+	const transfer = transfer_buffer(series.cumulativeP.buffer);
+	if(encoding !== 'compact') {
+		return {result: {series, type: 'result'}, transfer};
+	}
+	// Each power is encoded separately
+	// (null where it cannot be, so the packed elements are used instead)
+	const {cumulativeP, offsets} = series;
+	const compact = series.powers.map((_, i) => CompactDistribution.encode(
+		cumulativeP.subarray(offsets[i] * 3, offsets[i + 1] * 3),
+		make_shared_buffer
+	));
+	compact.filter((c) => c)
+		.forEach((c) => transfer.push(...transfer_buffer(c.buffer)));
+	return {
+		result: {series: Object.assign({compact}, series), type: 'result'},
+		transfer,
+	};
+}
+
+function package_odds_cache_stats(stats) {
+	return {result: {stats, type: 'result'}, transfer: []};
+}
+
+function package_threshold(threshold) {
+	return {result: {threshold, type: 'result'}, transfer: []};
+}
+
+function make_task_types(handlers) {
+	// Maps each task type to its handler (fn) and result packaging
+	const task = (fn, pack, labelKey = null) => ({fn, labelKey, pack});
+	return {
+		compound: task(handlers.compound, package_result),
+		generate: task(handlers.generate, package_result, 'tickets'),
+		histogram: task(handlers.histogram, package_histogram, 'tickets'),
+		odds_cache_stats: task(
+			handlers.odds_cache_stats,
+			package_odds_cache_stats
+		),
+		portfolio: task(handlers.portfolio, package_result),
+		pow: task(handlers.pow, package_result, 'power'),
+		pow_series: task(handlers.pow_series, package_series),
+		summary: task(handlers.summary, package_summary, 'tickets'),
+		threshold: task(handlers.threshold, package_threshold, 'tickets'),
+	};
+}
+
+function install_nodejs_worker(listener, post, clock) {
+	const {parentPort, workerData} = require('worker_threads');
+	if(!parentPort || !workerData || !workerData.raffleWorker) {
+		return;
+	}
+	const {performance} = require('perf_hooks');
+	clock.now = () => performance.now();
+	post.fn = (msg, transfer) => parentPort.postMessage(msg, transfer);
+	parentPort.on('message', (data) => listener({data}));
+	parentPort.postMessage({type: 'loaded'});
 }
 
-const prep = loadWASM().then(({calculate_cprobability_map}) => {
+function install_worker(listener, post, clock) {
+	if(typeof self !== 'undefined') {
+		if(self.performance) {
+			clock.now = () => self.performance.now();
+		}
+		post.fn = (msg, transfer) => self.postMessage(msg, transfer);
+		self.addEventListener('message', listener);
+		self.postMessage({type: 'loaded'});
+	} else if(typeof module === 'object') {
+		install_nodejs_worker(listener, post, clock);
+	}
+}
+
+const options = worker_options();
+
+const prep = Promise.all([
+	loadWASM(WASM_SOURCES[options.precision]),
+	(options.measureDeviation && options.precision !== 'float64')
+		? loadWASM(WASM_SOURCES.float64)
+		: null,
+]).then(([{
+	calculate_cprobability_map,
+	calculate_histogram,
+	calculate_summary,
+	calculate_threshold,
+	odds_cache_stats,
+}, reference]) => {
 	const post = {fn: () => null};
-	let perf_now = () => 0;
+	const clock = {now: () => 0};
 
 	const LEVEL = {
 		aggregate: 999,
@@ -209,11 +330,15 @@ const prep = loadWASM().then(({calculate_cprobability_map}) => {
 		return m;
 	}
 
+	function unit_pmap() {
+		const pMap = sharedMaps.get();
+		pMap.set(0, 1);
+		return pMap;
+	}
+
 	function pow(pMap, power, pCutoff) {
 		if(power === 0) {
-			const p1Map = sharedMaps.get();
-			p1Map.set(0, 1);
-			return p1Map;
+			return unit_pmap();
 		}
 
 		let fullPMap = null;
@@ -234,6 +359,72 @@ const prep = loadWASM().then(({calculate_cprobability_map}) => {
 		return fullPMap;
 	}
 
+	function square_cache(pMap, pCutoff) {
+		// Powers pMap^(2^i), calculated on demand
+		const squares = [pMap];
+		return {
+			get: (i) => {
+				while(squares.length <= i) {
+					const last = squares[squares.length - 1];
+					squares.push(mult(last, last, pCutoff));
+				}
+				return squares[i];
+			},
+			release: () => squares.slice(1).forEach((m) => sharedMaps.put(m)),
+			release_map: (m) => {
+				if(m && !squares.includes(m)) {
+					sharedMaps.put(m);
+				}
+			},
+		};
+	}
+
+	function advance_power(current, diff, squares, pCutoff) {
+		// Returns current * pMap^diff, releasing intermediate maps
+		let next = current;
+		/* eslint-disable no-bitwise */
+		for(let d = diff, bit = 0; d > 0; d >>>= 1, ++ bit) {
+			if(d & 1) {
+				const m = mult(next, squares.get(bit), pCutoff);
+				if(next !== current) {
+					squares.release_map(next);
+				}
+				next = m;
+			}
+		}
+		/* eslint-enable no-bitwise */
+		return next;
+	}
+
+	function pow_series(pMap, powers, pCutoff, fn) {
+		// Calls fn(power, pMapN) for each of the (unique, ascending) powers
+		// (pMapN is only valid during the call)
+		// Each result extends the one before using cached squares of pMap
+		const squares = square_cache(pMap, pCutoff);
+		let current = null;
+		let previous = 0;
+		for(const power of powers) {
+			const next = advance_power(
+				current,
+				power - previous,
+				squares,
+				pCutoff
+			);
+			const result = next || unit_pmap();
+			fn(power, result);
+			if(result !== next) {
+				sharedMaps.put(result);
+			}
+			if(current !== next) {
+				squares.release_map(current);
+			}
+			current = next;
+			previous = power;
+		}
+		squares.release_map(current);
+		squares.release();
+	}
+
 	function compound(parts, pCutoff) {
 		const P = 1;
 		const VALUE = 2;
@@ -253,7 +444,21 @@ const prep = loadWASM().then(({calculate_cprobability_map}) => {
 	}
 
 	function message_handler_generate({prizes, tickets, pCutoff}) {
-		return calculate_cprobability_map(prizes, tickets, pCutoff);
+		const result = calculate_cprobability_map(prizes, tickets, pCutoff);
+		if(reference) {
+			result.deviation = measure_deviation(
+				result.cumulativeP,
+				reference.calculate_cprobability_map(prizes, tickets, pCutoff)
+					.cumulativeP
+			);
+			post.fn({
+				message: `${options.precision} deviation for ${tickets}: ` +
+					`${result.deviation.cumulativeP.toExponential(2)} (cp), ` +
+					`${result.deviation.mean.toExponential(2)} (mean)`,
+				type: 'info',
+			});
+		}
+		return result;
 	}
 
 	function message_handler_pow({cumulativeP, power, pCutoff}) {
@@ -267,6 +472,34 @@ const prep = loadWASM().then(({calculate_cprobability_map}) => {
 		return result;
 	}
 
+	function message_handler_pow_series({cumulativeP, powers, pCutoff}) {
+		// Returns all results packed into a single buffer
+		// (offsets[i] is the index of the first element for sortedPowers[i])
+		const sortedPowers = Array.from(new Set(powers))
+			.sort((a, b) => (a - b));
+		const pMap1 = make_pmap(cumulativeP);
+		const parts = [];
+		pow_series(pMap1, sortedPowers, pCutoff, (power, pMapN) => {
+			parts.push(extract_cumulative_probability(pMapN, pCutoff));
+		});
+		sharedMaps.put(pMap1);
+
+		const offsets = new Uint32Array(parts.length + 1);
+		for(let i = 0; i < parts.length; ++ i) {
+			offsets[i + 1] = offsets[i] + parts[i].cumulativeP.length / 3;
+		}
+		const packed = make_shared_float_array(offsets[parts.length] * 3);
+		for(let i = 0; i < parts.length; ++ i) {
+			packed.set(parts[i].cumulativeP, offsets[i] * 3);
+		}
+		return {
+			cumulativeP: packed,
+			normalisations: parts.map(({totalP}) => totalP),
+			offsets,
+			powers: sortedPowers,
+		};
+	}
+
 	function message_handler_compound({parts, pCutoff}) {
 		const pMap = compound(parts, pCutoff);
 		const result = extract_cumulative_probability(pMap, pCutoff);
@@ -274,36 +507,44 @@ const prep = loadWASM().then(({calculate_cprobability_map}) => {
 		return result;
 	}
 
+	function message_handler_portfolio({parts, pCutoff, quantum}) {
+		return Convolution.convolve_all(
+			parts,
+			{pCutoff, quantum},
+			make_shared_float_array
+		);
+	}
+
+	const TASK_TYPES = make_task_types({
+		compound: message_handler_compound,
+		generate: message_handler_generate,
+		histogram: (data) => calculate_histogram(data, data),
+		odds_cache_stats,
+		portfolio: message_handler_portfolio,
+		pow: message_handler_pow,
+		pow_series: message_handler_pow_series,
+		summary: (data) => calculate_summary(
+			data,
+			data.percentiles,
+			data.thresholds
+		),
+		threshold: (data) => calculate_threshold(data, data),
+	});
+
 	function message_handler(data) {
-		const tB = perf_now();
-		let result = null;
+		const tB = clock.now();
+		const task = TASK_TYPES[data.type];
 		let label = data.type;
-
-		switch(data.type) {
-		case 'generate':
-			result = message_handler_generate(data);
-			label += ` ${data.tickets}`;
-			break;
-		case 'pow':
-			result = message_handler_pow(data);
-			label += ` ${data.power}`;
-			break;
-		case 'compound':
-			result = message_handler_compound(data);
-			break;
+		if(task.labelKey) {
+			label += ` ${data[task.labelKey]}`;
 		}
 
-		const tE = perf_now();
+		const packaged = task.pack(task.fn(data), data.encoding);
+
+		const tE = clock.now();
 		send_profiling(`Total for ${label}`, tE - tB, LEVEL.info, data.type);
 
-		return {
-			result: {
-				cumulativeP: result.cumulativeP,
-				normalisation: result.totalP,
-				type: 'result',
-			},
-			transfer: transfer_buffer(result.cumulativeP.buffer),
-		};
+		return packaged;
 	}
 
 	function message_listener({data}) {
@@ -320,26 +561,17 @@ const prep = loadWASM().then(({calculate_cprobability_map}) => {
 		}
 	}
 
-	function install_worker() {
-		if(typeof self !== 'undefined') {
-			if(self.performance) {
-				perf_now = () => self.performance.now();
-			}
-			post.fn = (msg, transfer) => self.postMessage(msg, transfer);
-			self.addEventListener('message', message_listener);
-			self.postMessage({type: 'loaded'});
-		}
-	}
-
-	install_worker();
+	install_worker(message_listener, post, clock);
 
 	return {
 		SynchronousEngine,
 		extract_cumulative_probability,
+		measure_deviation,
 		message_listener,
 		mult,
 		post,
 		pow,
+		pow_series,
 	};
 });
 
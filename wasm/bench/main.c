@@ -0,0 +1,93 @@
+/*
+ * Compares ln(a!) - ln(b!) computed as a difference of two Stirling
+ * evaluations (the previous approach) against ln_factorial_ratio, for
+ * audience-sized arguments. Errors are measured against a long double
+ * sum of logs.
+ *
+ * Build & run: npm run bench
+ */
+
+#include "../src/ln_factorial.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_CALLS 2000000
+
+static volatile double benchSink = 0.0;
+
+double seconds() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+double paired(unsigned long long a, unsigned long long b) {
+	return ln_factorial(a) - ln_factorial(b);
+}
+
+long double reference(unsigned long long a, unsigned long long b) {
+	long double r = 0.0L;
+	for (unsigned long long i = b + 1; i <= a; ++ i) {
+		r += logl((long double) i);
+	}
+	return r;
+}
+
+double time_calls(
+	double (*fn)(unsigned long long, unsigned long long),
+	unsigned long long total,
+	unsigned long long d
+) {
+	const double begin = seconds();
+	double sum = 0.0;
+	for (unsigned int i = 0; i < BENCH_CALLS; ++ i) {
+		const unsigned long long a = total + (i & 1023);
+		sum += fn(a, a - d);
+	}
+	benchSink += sum;
+	return (seconds() - begin) * 1e9 / BENCH_CALLS;
+}
+
+double relative_error(
+	double (*fn)(unsigned long long, unsigned long long),
+	unsigned long long total,
+	unsigned long long d
+) {
+	double worst = 0.0;
+	for (unsigned int i = 0; i < 64; ++ i) {
+		const unsigned long long a = total + i * 7919;
+		const long double r = reference(a, a - d);
+		const double e = (double) fabsl((fn(a, a - d) - r) / r);
+		if (e > worst) {
+			worst = e;
+		}
+	}
+	return worst;
+}
+
+int main() {
+	ln_factorial_prep();
+
+	const unsigned long long totals[] = {1000000000ull, 100000000000ull};
+	const unsigned long long diffs[] = {1, 10, 100, 1000, 100000};
+
+	printf("%14s %8s %12s %12s %12s %12s\n",
+		"audience", "a - b", "paired ns", "ratio ns", "paired err", "ratio err");
+	for (unsigned int t = 0; t < sizeof(totals) / sizeof(totals[0]); ++ t) {
+		for (unsigned int i = 0; i < sizeof(diffs) / sizeof(diffs[0]); ++ i) {
+			const unsigned long long total = totals[t];
+			const unsigned long long d = diffs[i];
+			printf("%14llu %8llu %12.1f %12.1f %12.2e %12.2e\n",
+				total,
+				d,
+				time_calls(paired, total, d),
+				time_calls(ln_factorial_ratio, total, d),
+				relative_error(paired, total, d),
+				relative_error(ln_factorial_ratio, total, d)
+			);
+		}
+	}
+	return 0;
+}
@@ -20,6 +20,14 @@ describe(calculate_odds) {
 		assertNear(odds->values[0], 1.0, 1e-12);
 	}
 
+	it("gives an exact list if every ticket wins") {
+		const struct PositionedList* odds = calculate_odds_nopad(7, 7, 3);
+
+		assertEqual(odds->start, 3);
+		assertEqual(odds->length, 1);
+		assertNear(odds->values[0], 1.0, 1e-12);
+	}
+
 	it("gives an exact list for 1 sample") {
 		const struct PositionedList* odds = calculate_odds(7, 5, 1);
 
@@ -88,7 +96,7 @@ void checkFinalOdds(
 	const struct PositionedList* odds = calculate_odds(total, targets, samples);
 	const double actual = calculate_final_odds(total, targets, samples);
 	const double expected = odds->values[odds->length - 1];
-	assertNear(actual, expected, tolerance);
+	assertNear(actual, expected, probTolerance(tolerance));
 }
 
 describe(calculate_final_odds) {
@@ -104,6 +112,17 @@ describe(calculate_final_odds) {
 		checkFinalOdds(100, 20, 1, 1e-12);
 	}
 
+	it("is precise for very large audiences") {
+		// (x / T) * ((x - 1) / (T - 1)) * ((x - 2) / (T - 2))
+		const double expected = (
+			(3000000000.0 / 100000000000.0) *
+			(2999999999.0 / 99999999999.0) *
+			(2999999998.0 / 99999999998.0)
+		);
+		const double actual = calculate_final_odds(100000000000ull, 3000000000ull, 3);
+		assertNear(actual / expected, 1.0, 1e-12);
+	}
+
 	it("recognises impossible outcomes") {
 		double actual = calculate_final_odds(7, 2, 4);
 
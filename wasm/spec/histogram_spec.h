@@ -0,0 +1,66 @@
+#include "util.h"
+#include "../src/histogram.h"
+#include "../src/prizes.h"
+
+describe(histogram) {
+	it("aggregates probabilities into bins") {
+		reset_prizes();
+		add_prize(1, 10);
+		add_prize(3, 5);
+		add_prize(4, 0);
+		const struct Histogram* h = calculate_histogram(4, 0.0, 3, 0.0, 30.0, 0);
+
+		// p(0) = 0.0142857, p(5) = 0.1714286, p(10) = 0.3142857,
+		// p(15) = 0.3142857, p(20) = 0.1714286, p(25) = 0.0142857
+		assertEqual(h->bins, 3);
+		assertNear(h->totalP, 1.0, 1e-6);
+		assertNear(h->below, 0.0, 1e-12);
+		assertNear(h->above, 0.0, 1e-12);
+		assertNear(h->data[0], 0.1857143, 1e-6); // 0, 5
+		assertNear(h->data[1], 0.6285714, 1e-6); // 10, 15
+		assertNear(h->data[2], 0.1857143, 1e-6); // 20, 25
+	}
+
+	it("records values outside the range separately") {
+		reset_prizes();
+		add_prize(1, 10);
+		add_prize(3, 5);
+		add_prize(4, 0);
+		const struct Histogram* h = calculate_histogram(4, 0.0, 2, 5.0, 25.0, 0);
+
+		assertNear(h->below, 0.0142857, 1e-6); // 0
+		assertNear(h->data[0], 0.4857143, 1e-6); // 5, 10
+		assertNear(h->data[1], 0.4857143, 1e-6); // 15, 20
+		assertNear(h->above, 0.0142857, 1e-6); // 25
+	}
+
+	it("supports logarithmic bins") {
+		reset_prizes();
+		add_prize(1, 10);
+		add_prize(3, 5);
+		add_prize(4, 0);
+		// Bin edges at log1p(v) = 0, 1, 2, 3, 4 (v = 0, 1.7, 6.4, 19.1, 53.6)
+		const struct Histogram* h = calculate_histogram(4, 0.0, 4, 0.0, 53.59815, 1);
+
+		assertNear(h->data[0], 0.0142857, 1e-6); // 0
+		assertNear(h->data[1], 0.1714286, 1e-6); // 5
+		assertNear(h->data[2], 0.6285714, 1e-6); // 10, 15
+		assertNear(h->data[3], 0.1857143, 1e-6); // 20, 25
+	}
+
+	it("builds a pyramid of coarser levels") {
+		reset_prizes();
+		add_prize(1, 10);
+		add_prize(3, 5);
+		add_prize(4, 0);
+		const struct Histogram* h = calculate_histogram(4, 0.0, 6, 0.0, 30.0, 0);
+
+		assertEqual(h->levels, 4); // 6, 3, 2, 1
+		assertNear(h->data[6], 0.1857143, 1e-6);
+		assertNear(h->data[7], 0.6285714, 1e-6);
+		assertNear(h->data[8], 0.1857143, 1e-6);
+		assertNear(h->data[9], 0.8142857, 1e-6);
+		assertNear(h->data[10], 0.1857143, 1e-6);
+		assertNear(h->data[11], 1.0, 1e-6);
+	}
+}
@@ -30,4 +30,23 @@ describe(ln_factorial) {
 
 		assertNear(exp(a - b), 1000000001, 1e4);
 	}
+
+	it("calculates ratios of factorials") {
+		assertNear(ln_factorial_ratio(4, 2), log(12.0), 1e-9);
+		assertNear(ln_factorial_ratio(2, 4), -log(12.0), 1e-9);
+		assertNear(ln_factorial_ratio(300, 256), ln_factorial(300) - ln_factorial(256), 1e-6);
+		assertNear(ln_factorial_ratio(1000000, 5), ln_factorial(1000000) - ln_factorial(5), 1e-6);
+	}
+
+	it("calculates ratios of large factorials without cancellation") {
+		// Exactly ln(1000000001)
+		assertNear(ln_factorial_ratio(1000000001, 1000000000), log(1000000001.0), 1e-12);
+
+		long double expected = 0.0L;
+		for (unsigned long long i = 100000000001ull; i <= 100000001000ull; ++ i) {
+			expected += logl((long double) i);
+		}
+		const double actual = ln_factorial_ratio(100000001000ull, 100000000000ull);
+		assertNear(actual, (double) expected, 1e-9);
+	}
 }
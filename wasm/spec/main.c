@@ -1,7 +1,12 @@
 #include "utils.h"
 #include "ln_factorial_spec.h"
 #include "calculate_odds_spec.h"
+#include "odds_cache_spec.h"
 #include "calculate_probability_map_spec.h"
+#include "summary_spec.h"
+#include "histogram_spec.h"
+#include "threshold_spec.h"
+#include "simple_prizes_spec.h"
 #include "../src/ln_factorial.h"
 
 int main() {
@@ -10,7 +15,12 @@ int main() {
 	run_suite(ln_factorial);
 	run_suite(calculate_odds);
 	run_suite(calculate_final_odds);
+	run_suite(odds_cache);
 	run_suite(calculate_probability_map);
+	run_suite(summary);
+	run_suite(histogram);
+	run_suite(threshold);
+	run_suite(simple_prizes);
 
 	return conclude_tests();
 }
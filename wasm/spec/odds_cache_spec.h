@@ -0,0 +1,60 @@
+#include "util.h"
+#include "../src/odds_cache.h"
+
+describe(odds_cache) {
+	it("returns the same values as calculate_odds") {
+		reset_odds_cache();
+		const struct OddsWindow* cached = cached_odds(9, 5, 4);
+		assertEqual(cached->start, 0);
+		assertEqual(cached->length, 5);
+		assertNear(cached->values[0],  1.0 / 126, 1e-6);
+		assertNear(cached->values[1], 20.0 / 126, 1e-6);
+		assertNear(cached->values[2], 60.0 / 126, 1e-6);
+		assertNear(cached->values[3], 40.0 / 126, 1e-6);
+		assertNear(cached->values[4],  5.0 / 126, 1e-6);
+	}
+
+	it("stores only the non-zero window") {
+		reset_odds_cache();
+		const struct OddsWindow* cached = cached_odds(7, 5, 4);
+		assertEqual(cached->start, 2);
+		assertEqual(cached->length, 3);
+		assertNear(cached->values[0], 2.0 / 7, 1e-6);
+		assertNear(cached->values[1], 4.0 / 7, 1e-6);
+		assertNear(cached->values[2], 1.0 / 7, 1e-6);
+	}
+
+	it("reuses previously calculated rows") {
+		reset_odds_cache();
+		const struct OddsCacheStats* stats = get_odds_cache_stats();
+		const double hits = stats->hits;
+		const double misses = stats->misses;
+
+		cached_odds(100, 20, 10);
+		cached_odds(100, 30, 10);
+		const struct OddsWindow* cached = cached_odds(100, 20, 10);
+
+		stats = get_odds_cache_stats();
+		assertNear(stats->hits - hits, 1.0, 0.0);
+		assertNear(stats->misses - misses, 2.0, 0.0);
+		assertNear(stats->entries, 2.0, 0.0);
+
+		const struct PositionedList* odds = calculate_odds_nopad(100, 20, 10);
+		for (unsigned int i = 0; i < cached->length; ++ i) {
+			assertNear(
+				cached->values[i],
+				odds->values[cached->start - odds->start + i],
+				0.0
+			);
+		}
+	}
+
+	it("does not store trivial rows") {
+		reset_odds_cache();
+		cached_odds(100, 20, 1);
+		cached_odds(100, 0, 5);
+		cached_odds(100, 100, 5);
+
+		assertNear(get_odds_cache_stats()->entries, 0.0, 0.0);
+	}
+}
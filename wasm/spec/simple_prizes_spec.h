@@ -0,0 +1,109 @@
+#include "util.h"
+#include "../src/simple_prizes.h"
+#include "../src/calculate_probability_map.h"
+#include "../src/prizes.h"
+
+static struct CumulativeProbMap expectedCPMap;
+
+void checkMatchesGeneral(unsigned int tickets, double pCutoff, double tolerance) {
+	struct ProbMap* pMap = calculate_probability_map(
+		sharedPrizes,
+		sharedPrizesLength,
+		tickets,
+		pCutoff
+	);
+	expectedCPMap = *extract_cumulative_probability(pMap, pCutoff);
+	freeProbMap(pMap);
+
+	const struct CumulativeProbMap* actual = calculate_simple_cprobability_map(
+		sharedPrizes,
+		sharedPrizesLength,
+		tickets,
+		pCutoff
+	);
+	if (!actual) {
+		fail("Expected simple prizes to be handled");
+	}
+	assertEqual(actual->dataLength, expectedCPMap.dataLength);
+	for (unsigned int i = 0; i < expectedCPMap.dataLength; ++ i) {
+		assertNear(actual->data[i].value, expectedCPMap.data[i].value, 1e-12);
+		assertNear(actual->data[i].p, expectedCPMap.data[i].p, probTolerance(tolerance));
+		assertNear(actual->data[i].cp, expectedCPMap.data[i].cp, probTolerance(tolerance));
+	}
+}
+
+describe(simple_prizes) {
+	it("matches the general calculation for a single prize tier") {
+		reset_prizes();
+		add_prize(3, 10);
+		add_prize(17, 0);
+		for (unsigned int tickets = 0; tickets <= 20; ++ tickets) {
+			checkMatchesGeneral(tickets, 0.0, 1e-9);
+		}
+	}
+
+	it("matches the general calculation for two prize tiers") {
+		reset_prizes();
+		add_prize(2, 25);
+		add_prize(5, 10);
+		add_prize(13, 0);
+		for (unsigned int tickets = 0; tickets <= 20; ++ tickets) {
+			checkMatchesGeneral(tickets, 0.0, 1e-9);
+		}
+	}
+
+	it("combines tiers which produce the same values") {
+		reset_prizes();
+		add_prize(4, 2);
+		add_prize(6, 1);
+		add_prize(10, 0);
+		checkMatchesGeneral(8, 0.0, 1e-9);
+	}
+
+	it("handles prize tables where every ticket wins") {
+		reset_prizes();
+		add_prize(3, 5);
+		add_prize(2, 1);
+		checkMatchesGeneral(4, 0.0, 1e-9);
+
+		reset_prizes();
+		add_prize(6, 5);
+		checkMatchesGeneral(4, 0.0, 1e-9);
+	}
+
+	it("matches the general calculation for large audiences") {
+		reset_prizes();
+		add_prize(20, 1000);
+		add_prize(3000, 25);
+		add_prize(50000000, 0);
+		checkMatchesGeneral(200, 1e-20, 1e-9);
+	}
+
+	it("returns a single value if there are no prizes") {
+		reset_prizes();
+		add_prize(10, 0);
+		const struct CumulativeProbMap* actual = calculate_simple_cprobability_map(
+			sharedPrizes,
+			sharedPrizesLength,
+			5,
+			0.0
+		);
+		assertEqual(actual->dataLength, 1);
+		assertNear(actual->data[0].value, 0.0, 1e-12);
+		assertNear(actual->data[0].p, 1.0, 1e-12);
+	}
+
+	it("leaves complex prize tables to the general calculation") {
+		reset_prizes();
+		add_prize(1, 10);
+		add_prize(3, 5);
+		add_prize(4, 1);
+		add_prize(4, 0);
+		assertEqual(calculate_simple_cprobability_map(
+			sharedPrizes,
+			sharedPrizesLength,
+			4,
+			0.0
+		) == 0, 1);
+	}
+}
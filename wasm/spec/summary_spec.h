@@ -0,0 +1,78 @@
+#include "util.h"
+#include "../src/summary.h"
+#include "../src/prizes.h"
+
+describe(summary) {
+	it("calculates moments of the final distribution") {
+		reset_prizes();
+		add_prize(1, 10);
+		add_prize(3, 5);
+		add_prize(4, 0);
+		reset_summary_queries();
+		const struct Summary* summary = calculate_summary(4, 0.0);
+
+		// p(0) = 0.0142857, p(5) = 0.1714286, p(10) = 0.3142857,
+		// p(15) = 0.3142857, p(20) = 0.1714286, p(25) = 0.0142857
+		assertNear(summary->totalP, 1.0, 1e-6);
+		assertNear(summary->min, 0.0, 1e-12);
+		assertNear(summary->max, 25.0, 1e-12);
+		assertNear(summary->mean, 12.5, 1e-6);
+		assertNear(summary->variance, 27.6785714, 1e-6);
+		assertNear(summary->mode, 15.0, 1e-12);
+	}
+
+	it("calculates requested percentiles") {
+		reset_prizes();
+		add_prize(1, 10);
+		add_prize(3, 5);
+		add_prize(4, 0);
+		reset_summary_queries();
+		add_percentile_query(0);
+		add_percentile_query(1);
+		add_percentile_query(18);
+		add_percentile_query(50);
+		add_percentile_query(51);
+		add_percentile_query(100);
+		const struct Summary* summary = calculate_summary(4, 0.0);
+
+		assertEqual(summary->percentilesLength, 6);
+		assertNear(summary->percentiles[0], 0.0, 1e-12);
+		assertNear(summary->percentiles[1], 0.0, 1e-12);
+		assertNear(summary->percentiles[2], 5.0, 1e-12);
+		assertNear(summary->percentiles[3], 10.0, 1e-12);
+		assertNear(summary->percentiles[4], 15.0, 1e-12);
+		assertNear(summary->percentiles[5], 25.0, 1e-12);
+	}
+
+	it("calculates the probability of reaching thresholds") {
+		reset_prizes();
+		add_prize(1, 10);
+		add_prize(3, 5);
+		add_prize(4, 0);
+		reset_summary_queries();
+		add_threshold_query(0);
+		add_threshold_query(11);
+		add_threshold_query(25);
+		add_threshold_query(26);
+		const struct Summary* summary = calculate_summary(4, 0.0);
+
+		assertEqual(summary->thresholdsLength, 4);
+		assertNear(summary->thresholds[0], 1.0, 1e-6);
+		assertNear(summary->thresholds[1], 0.5, 1e-6);
+		assertNear(summary->thresholds[2], 0.0142857, 1e-6);
+		assertNear(summary->thresholds[3], 0.0, 1e-12);
+	}
+
+	it("ignores values below the cutoff") {
+		reset_prizes();
+		add_prize(1, 10);
+		add_prize(3, 5);
+		add_prize(4, 0);
+		reset_summary_queries();
+		const struct Summary* summary = calculate_summary(4, 0.1);
+
+		assertNear(summary->min, 5.0, 1e-12);
+		assertNear(summary->max, 20.0, 1e-12);
+		assertNear(summary->totalP, 0.9714286, 1e-6);
+	}
+}
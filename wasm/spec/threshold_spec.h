@@ -0,0 +1,84 @@
+#include "util.h"
+#include "../src/threshold.h"
+#include "../src/summary.h"
+#include "../src/prizes.h"
+
+describe(threshold) {
+	it("calculates the probability of reaching a threshold") {
+		reset_prizes();
+		add_prize(1, 10);
+		add_prize(3, 5);
+		add_prize(4, 0);
+
+		// p(0) = 0.0142857, p(5) = 0.1714286, p(10) = 0.3142857,
+		// p(15) = 0.3142857, p(20) = 0.1714286, p(25) = 0.0142857
+		const struct ThresholdProbability* t = calculate_threshold(4, 11.0, 0.0);
+		assertNear(t->above, 0.5, 1e-6);
+		assertNear(t->below, 0.5, 1e-6);
+		assertNear(t->error, 0.0, 1e-12);
+
+		t = calculate_threshold(4, 25.0, 0.0);
+		assertNear(t->above, 0.0142857, 1e-6);
+		assertNear(t->below, 0.9857143, 1e-6);
+
+		t = calculate_threshold(4, 0.0, 0.0);
+		assertNear(t->above, 1.0, 1e-12);
+		assertNear(t->below, 0.0, 1e-12);
+
+		t = calculate_threshold(4, 26.0, 0.0);
+		assertNear(t->above, 0.0, 1e-12);
+		assertNear(t->below, 1.0, 1e-12);
+	}
+
+	it("does not depend on the order of prizes") {
+		reset_prizes();
+		add_prize(4, 0);
+		add_prize(1, 10);
+		add_prize(3, 5);
+		const struct ThresholdProbability* t = calculate_threshold(4, 11.0, 0.0);
+
+		assertNear(t->above, 0.5, 1e-6);
+		assertNear(t->below, 0.5, 1e-6);
+	}
+
+	it("matches the full distribution for larger raffles") {
+		reset_prizes();
+		add_prize(2, 1000);
+		add_prize(15, 100);
+		add_prize(100, 10);
+		add_prize(80, 5);
+		add_prize(1000, 0);
+		reset_summary_queries();
+		add_threshold_query(50.0);
+		add_threshold_query(1000.0);
+		const struct Summary* summary = calculate_summary(30, 0.0);
+		const double expected50 = summary->thresholds[0];
+		const double expected1000 = summary->thresholds[1];
+
+		const struct ThresholdProbability* t = calculate_threshold(30, 50.0, 0.0);
+		assertNear(t->above, expected50, probTolerance(1e-9));
+		assertNear(t->above + t->below, 1.0, probTolerance(1e-9));
+
+		t = calculate_threshold(30, 1000.0, 0.0);
+		assertNear(t->above, expected1000, probTolerance(1e-9));
+	}
+
+	it("discards no more than the requested tolerance") {
+		reset_prizes();
+		add_prize(2, 1000);
+		add_prize(15, 100);
+		add_prize(100, 10);
+		add_prize(80, 5);
+		add_prize(1000, 0);
+		const double exact = calculate_threshold(30, 50.0, 0.0)->above;
+
+		const struct ThresholdProbability* t = calculate_threshold(30, 50.0, 1e-4);
+		if (t->error > 1e-4) {
+			fail("Expected error %f to be within tolerance", t->error);
+		}
+		if (exact < t->above - 1e-9 || exact > t->above + t->error + 1e-9) {
+			fail("Expected %f to be within [%f %f]", exact, t->above, t->above + t->error);
+		}
+		assertNear(t->above + t->below + t->error, 1.0, probTolerance(1e-9));
+	}
+}
@@ -54,6 +54,14 @@ void _assertNear(const char *file, int line, double a, double b, double toleranc
 }
 #define assertNear(a, b, tolerance) _assertNear(__FILE__, __LINE__, a, b, tolerance)
 
+// Loosens tolerances for probabilities which are stored in single precision
+// (see PROB_FLOAT32 in options.h)
+#ifdef PROB_FLOAT32
+#define probTolerance(tolerance) ((tolerance) > 1e-5 ? (tolerance) : 1e-5)
+#else
+#define probTolerance(tolerance) (tolerance)
+#endif
+
 int conclude_tests() {
 	printf("total tests: %d, failures: %d\n", testCount, testFailures);
 	if (testFailures > 0) {
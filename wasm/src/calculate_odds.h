@@ -9,7 +9,7 @@
 struct PositionedList {
 	unsigned int start;
 	unsigned int length;
-	double values[MAX_ODDS_BUCKETS];
+	prob_t values[MAX_ODDS_BUCKETS];
 };
 
 static struct PositionedList sharedOdds;
@@ -46,13 +46,13 @@ const struct PositionedList* calculate_odds_nopad(
 		return &sharedOdds;
 	} else if (targets == total) {
 		sharedOdds.values[0] = 1.0;
-		sharedOdds.start = (int) (total - 1);
+		sharedOdds.start = samples;
 		sharedOdds.length = 1;
 		return &sharedOdds;
 	} else if (samples == 1) {
 		double p = targets / (double) total;
-		sharedOdds.values[0] = 1.0 - p;
-		sharedOdds.values[1] = p;
+		sharedOdds.values[0] = (prob_t) (1.0 - p);
+		sharedOdds.values[1] = (prob_t) p;
 		sharedOdds.start = 0;
 		sharedOdds.length = 2;
 		return &sharedOdds;
@@ -60,16 +60,17 @@ const struct PositionedList* calculate_odds_nopad(
 
 	long long B = targets + samples - total;
 
+	// Terms are paired so that each pair differs by at most samples
 	double cur = (
-		ln_factorial(total - samples) - ln_factorial((B < 0) ? -B : B)
-		+ ln_factorial(total - targets) - ln_factorial(total)
+		ln_factorial_ratio(total - targets, (unsigned long long) ((B < 0) ? -B : B))
+		- ln_factorial_ratio(total, total - samples)
 	);
 
 	unsigned int begin = 0;
 	if (B > 0) {
 		cur += (
-			ln_factorial(targets) - ln_factorial(targets - B)
-			+ ln_factorial(samples) - ln_factorial(samples - B)
+			ln_factorial_ratio(targets, targets - (unsigned long long) B)
+			+ ln_factorial_ratio(samples, samples - (unsigned long long) B)
 		);
 		begin = (unsigned int) B;
 	}
@@ -89,7 +90,7 @@ const struct PositionedList* calculate_odds_nopad(
 	}
 
 	for (unsigned int n = begin; n < limit; ++ n) {
-		sharedOdds.values[n - begin] = cur;
+		sharedOdds.values[n - begin] = (prob_t) cur;
 
 		// A = foo / (targets - n)! / (samples - n)! / (n - B)! / n!
 		// B = foo / (targets-n-1)! / (samples-n-1)! / (n+1-B)! / (n+1)!
@@ -144,8 +145,8 @@ double calculate_final_odds(
 	}
 
 	return exp(
-		ln_factorial(total - samples) - ln_factorial(total)
-		+ ln_factorial(targets) - ln_factorial(targets - samples)
+		ln_factorial_ratio(targets, targets - samples)
+		- ln_factorial_ratio(total, total - samples)
 	);
 }
 
@@ -2,7 +2,9 @@
 #define CALCULATE_PROBABILITY_MAP_H_
 
 #include "calculate_odds.h"
+#include "odds_cache.h"
 #include "cumulative_probability.h"
+#include "simple_prizes.h"
 #include "prob_map.h"
 #include "memory.h"
 #include "prizes.h"
@@ -12,10 +14,10 @@
 
 static struct ProbMap* sharedTicketsProb[MAX_TICKETS + 1];
 
-unsigned int find_peak(const struct PositionedList* l) {
-	double previous = 0.0;
+unsigned int find_peak(const struct OddsWindow* l) {
+	prob_t previous = 0.0;
 	for (unsigned int i = 0; i < l->length; ++ i) {
-		const double v = l->values[i];
+		const prob_t v = l->values[i];
 		if (v < previous) {
 			return i - 1;
 		}
@@ -38,7 +40,7 @@ void apply_distribution(
 			continue;
 		}
 
-		const struct PositionedList* l = calculate_odds_nopad(
+		const struct OddsWindow* l = cached_odds(
 			audience,
 			prize->count,
 			limit - n - 1
@@ -52,7 +54,7 @@ void apply_distribution(
 				continue;
 			}
 			for (unsigned int i = maxInd; (i --) > 0;) {
-				double pp = iter->value * l->values[i];
+				const prob_t pp = iter->value * l->values[i];
 				if (pp <= pCutoff2) {
 					break;
 				}
@@ -60,7 +62,7 @@ void apply_distribution(
 				accumulateProbMap(prob[n + d], iter->key + d * prize->value, pp);
 			}
 			for (unsigned int i = maxInd; i < l->length; ++ i) {
-				double pp = iter->value * l->values[i];
+				const prob_t pp = iter->value * l->values[i];
 				if (pp <= pCutoff2) {
 					break;
 				}
@@ -93,13 +95,17 @@ void apply_final_distribution(
 		}
 		iterateProbMap(prob[n], iter, {
 			if (iter->value > 0.0) {
-				accumulateProbMap(targetP, iter->key + i * prize->value, iter->value * odds);
+				accumulateProbMap(
+					targetP,
+					iter->key + i * prize->value,
+					(prob_t) (iter->value * odds)
+				);
 			}
 		})
 	}
 }
 
-struct ProbMap* calculate_probability_map(
+unsigned long long prepare_probability_map(
 	const struct Prize* prizes,
 	unsigned int prizesLength,
 	unsigned int tickets,
@@ -111,6 +117,9 @@ struct ProbMap* calculate_probability_map(
 	 * that we can easily add elements to rows while iterating top-to-
 	 * bottom). The order of elements within a row doesn't matter, so
 	 * use a Map for faster lookups.
+	 *
+	 * Applies all but the final prize to sharedTicketsProb, and returns
+	 * the audience remaining for the final prize.
 	 */
 
 	if (tickets > MAX_TICKETS) {
@@ -141,6 +150,21 @@ struct ProbMap* calculate_probability_map(
 		);
 		remainingAudience -= prizes[p].count;
 	}
+	return remainingAudience;
+}
+
+struct ProbMap* calculate_probability_map(
+	const struct Prize* prizes,
+	unsigned int prizesLength,
+	unsigned int tickets,
+	double pCutoff
+) {
+	const unsigned long long remainingAudience = prepare_probability_map(
+		prizes,
+		prizesLength,
+		tickets,
+		pCutoff
+	);
 	apply_final_distribution(
 		sharedTicketsProb,
 		tickets + 1,
@@ -159,6 +183,16 @@ EMSCRIPTEN_KEEPALIVE const struct CumulativeProbMap* calculate_cprobability_map(
 	unsigned int tickets,
 	double pCutoff
 ) {
+	const struct CumulativeProbMap* simple = calculate_simple_cprobability_map(
+		sharedPrizes,
+		sharedPrizesLength,
+		tickets,
+		pCutoff
+	);
+	if (simple) {
+		return simple;
+	}
+
 	struct ProbMap* pMap = calculate_probability_map(
 		sharedPrizes,
 		sharedPrizesLength,
@@ -20,18 +20,46 @@ struct CumulativeProbMap {
 
 static struct CumulativeProbMap sharedCPMap;
 
+const struct CumulativeProbMap* finalise_cumulative_probability(
+	unsigned int length,
+	double pCutoff
+) {
+	// Takes the first length elements of sharedCPMap (sorted by value, with
+	// p and value populated), removes any with p <= pCutoff, then
+	// normalises to [0 1] to correct for numeric errors and assigns
+	// cumulative values
+	unsigned int count = 0;
+	double totalP = 0.0;
+	for (unsigned int i = 0; i < length; ++ i) {
+		if (sharedCPMap.data[i].p > pCutoff) {
+			totalP += sharedCPMap.data[i].p;
+			sharedCPMap.data[count] = sharedCPMap.data[i];
+			++ count;
+		}
+	}
+
+	double cp = 0.0;
+	sharedCPMap.totalP = totalP;
+	sharedCPMap.dataLength = count;
+	for (unsigned int i = 0; i < count; ++ i) {
+		cp += sharedCPMap.data[i].p;
+		sharedCPMap.data[i].cp = cp / totalP;
+		sharedCPMap.data[i].p /= totalP;
+	}
+
+	return &sharedCPMap;
+}
+
 const struct CumulativeProbMap* extract_cumulative_probability(
 	const struct ProbMap* pMap,
 	double pCutoff
 ) {
 	unsigned int count = 0;
-	double totalP = 0.0;
 	iterateProbMap(pMap, iter, {
 		if (iter->value > pCutoff) {
 			if (count >= MAX_CP_ELEMENTS) {
 				throw_error();
 			}
-			totalP += iter->value;
 			sharedCPMap.data[count].p = iter->value;
 			sharedCPMap.data[count].value = iter->key;
 			++ count;
@@ -40,17 +68,7 @@ const struct CumulativeProbMap* extract_cumulative_probability(
 
 	// pMap is already sorted low->high if a linkedmap
 
-	// Normalise to [0 1] to correct for numeric errors and assign cumulative values
-	double cp = 0.0;
-	sharedCPMap.totalP = totalP;
-	sharedCPMap.dataLength = count;
-	for (unsigned int i = 0; i < count; ++ i) {
-		cp += sharedCPMap.data[i].p;
-		sharedCPMap.data[i].cp = cp / totalP;
-		sharedCPMap.data[i].p /= totalP;
-	}
-
-	return &sharedCPMap;
+	return finalise_cumulative_probability(count, pCutoff);
 }
 
 #endif
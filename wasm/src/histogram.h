@@ -0,0 +1,170 @@
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include "calculate_odds.h"
+#include "calculate_probability_map.h"
+#include "prob_map.h"
+#include "prizes.h"
+#include "options.h"
+#include "imports.h"
+#include <math.h>
+
+struct Histogram {
+	double totalP;
+	double low;
+	double high;
+	double below; // p(value < low)
+	double above; // p(value >= high)
+	unsigned int bins;
+	unsigned int levels;
+
+	// Level 0 (bins elements), then each subsequent level combining pairs
+	// of bins from the level before, down to a single bin
+	double data[MAX_HISTOGRAM_BINS * 2];
+};
+
+static struct Histogram sharedHistogram;
+static double sharedHistogramScale = 0.0;
+static int sharedHistogramLog = 0;
+
+void reset_histogram(
+	unsigned int bins,
+	double low,
+	double high,
+	int logScale
+) {
+	if (bins < 1 || bins > MAX_HISTOGRAM_BINS || !(high > low)) {
+		throw_error();
+	}
+	sharedHistogram.bins = bins;
+	sharedHistogram.low = low;
+	sharedHistogram.high = high;
+	sharedHistogram.below = 0.0;
+	sharedHistogram.above = 0.0;
+	for (unsigned int i = 0; i < bins; ++ i) {
+		sharedHistogram.data[i] = 0.0;
+	}
+	sharedHistogramLog = logScale;
+	if (logScale) {
+		sharedHistogramScale = bins / log1p(high - low);
+	} else {
+		sharedHistogramScale = bins / (high - low);
+	}
+}
+
+void accumulate_histogram(double value, double p) {
+	if (value < sharedHistogram.low) {
+		sharedHistogram.below += p;
+		return;
+	}
+	if (value >= sharedHistogram.high) {
+		sharedHistogram.above += p;
+		return;
+	}
+	const double offset = value - sharedHistogram.low;
+	unsigned int bin = (unsigned int) (sharedHistogramScale * (
+		sharedHistogramLog ? log1p(offset) : offset
+	));
+	if (bin >= sharedHistogram.bins) {
+		bin = sharedHistogram.bins - 1;
+	}
+	sharedHistogram.data[bin] += p;
+}
+
+void apply_final_distribution_histogram(
+	struct ProbMap** prob,
+	unsigned int limit,
+	unsigned long long audience,
+	const struct Prize *prize
+) {
+	// Equivalent to apply_final_distribution, but accumulates directly
+	// into the histogram rather than building the final row
+	iterateProbMap(prob[limit - 1], iter, {
+		accumulate_histogram(iter->key, iter->value);
+	})
+	for (unsigned int n = limit - 1; (n --) > 0;) {
+		if (isEmptyProbMap(prob[n])) {
+			continue;
+		}
+		const unsigned int i = limit - n - 1;
+		const double odds = calculate_final_odds(audience, prize->count, i);
+		if (odds <= 0.0) {
+			continue;
+		}
+		const double extraValue = (double) i * prize->value;
+		iterateProbMap(prob[n], iter, {
+			if (iter->value > 0.0) {
+				accumulate_histogram(iter->key + extraValue, iter->value * odds);
+			}
+		})
+	}
+}
+
+void finalise_histogram() {
+	double totalP = sharedHistogram.below + sharedHistogram.above;
+	for (unsigned int i = 0; i < sharedHistogram.bins; ++ i) {
+		totalP += sharedHistogram.data[i];
+	}
+
+	// Normalise to [0 1] to correct for numeric errors
+	sharedHistogram.totalP = totalP;
+	if (totalP > 0.0) {
+		sharedHistogram.below /= totalP;
+		sharedHistogram.above /= totalP;
+		for (unsigned int i = 0; i < sharedHistogram.bins; ++ i) {
+			sharedHistogram.data[i] /= totalP;
+		}
+	}
+
+	// Build coarser levels by combining pairs of bins
+	unsigned int levels = 1;
+	unsigned int begin = 0;
+	unsigned int length = sharedHistogram.bins;
+	while (length > 1) {
+		const unsigned int next = begin + length;
+		const unsigned int nextLength = (length + 1) / 2;
+		for (unsigned int i = 0; i < nextLength; ++ i) {
+			double p = sharedHistogram.data[begin + i * 2];
+			if (i * 2 + 1 < length) {
+				p += sharedHistogram.data[begin + i * 2 + 1];
+			}
+			sharedHistogram.data[next + i] = p;
+		}
+		begin = next;
+		length = nextLength;
+		++ levels;
+	}
+	sharedHistogram.levels = levels;
+}
+
+EMSCRIPTEN_KEEPALIVE const struct Histogram* calculate_histogram(
+	unsigned int tickets,
+	double pCutoff,
+	unsigned int bins,
+	double low,
+	double high,
+	int logScale
+) {
+	reset_histogram(bins, low, high, logScale);
+
+	const unsigned long long remainingAudience = prepare_probability_map(
+		sharedPrizes,
+		sharedPrizesLength,
+		tickets,
+		pCutoff
+	);
+	apply_final_distribution_histogram(
+		sharedTicketsProb,
+		tickets + 1,
+		remainingAudience,
+		&sharedPrizes[sharedPrizesLength - 1]
+	);
+	for (unsigned int i = 0; i <= tickets; ++ i) {
+		freeProbMap(sharedTicketsProb[i]);
+	}
+
+	finalise_histogram();
+	return &sharedHistogram;
+}
+
+#endif
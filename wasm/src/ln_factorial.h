@@ -40,4 +40,50 @@ double ln_factorial(unsigned long long n) {
 	}
 }
 
+// Below this difference, ln(a!) - ln(b!) is found from the product of the
+// terms directly (the product of 16 values < 2^53 fits easily in a double)
+#define LNF_RATIO_PRODUCT_TERMS 16
+
+double calc_stirling_factorial_ratio(double a, double b) {
+	/*
+	 * calc_stirling_factorial(a) - calc_stirling_factorial(b), rearranged
+	 * so that the (large, nearly equal) terms cancel algebraically rather
+	 * than numerically:
+	 *
+	 * (a + 0.5) ln(a) - (b + 0.5) ln(b) = (b + 0.5) log1p(d / b) + d ln(a)
+	 * (1 / 12a) - (1 / 12b) = -d / 12ab
+	 * (1 / 360b^3) - (1 / 360a^3) = d (a^2 + ab + b^2) / 360a^3b^3
+	 */
+	const double d = a - b;
+	const double ab = a * b;
+	return (
+		(b + 0.5) * log1p(d / b)
+		+ d * log(a)
+		- d
+		- (d / 12.0) / ab
+		+ (d / 360.0) * (a * a + ab + b * b) / (ab * ab * ab)
+	);
+}
+
+double ln_factorial_ratio(unsigned long long a, unsigned long long b) {
+	// ln(a!) - ln(b!) = ln(a! / b!), without evaluating either factorial
+	if (a < b) {
+		return -ln_factorial_ratio(b, a);
+	}
+	if (a < CACHE_LNF_COUNT) {
+		return lookup[a] - lookup[b];
+	}
+	if (a - b <= LNF_RATIO_PRODUCT_TERMS) {
+		double product = 1.0;
+		for (unsigned long long i = b + 1; i <= a; ++ i) {
+			product *= (double) i;
+		}
+		return log(product);
+	}
+	if (b < CACHE_LNF_COUNT) {
+		return calc_stirling_factorial((double) a) - lookup[b];
+	}
+	return calc_stirling_factorial_ratio((double) a, (double) b);
+}
+
 #endif
@@ -2,6 +2,9 @@
 #include "ln_factorial.h"
 #include "calculate_odds.h"
 #include "calculate_probability_map.h"
+#include "summary.h"
+#include "histogram.h"
+#include "threshold.h"
 
 EMSCRIPTEN_KEEPALIVE void prep() {
 	ln_factorial_prep();
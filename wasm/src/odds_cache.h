@@ -0,0 +1,152 @@
+#ifndef ODDS_CACHE_H_
+#define ODDS_CACHE_H_
+
+#include "calculate_odds.h"
+#include "options.h"
+#include "imports.h"
+
+/*
+ * Rows of calculate_odds_nopad depend only on (total, targets, samples),
+ * so are kept between calls (e.g. for repeated generate calls with the
+ * same prizes but different ticket counts). Only the window of non-zero
+ * values is stored. When the table or value storage is full, everything
+ * is discarded and the cache starts again.
+ */
+
+struct OddsWindow {
+	unsigned int start;
+	unsigned int length;
+	const prob_t* values;
+};
+
+struct OddsCacheEntry {
+	unsigned long long total; // 0 = unused slot
+	unsigned long long targets;
+	unsigned int samples;
+	unsigned int start;
+	unsigned int length;
+	unsigned int offset;
+};
+
+struct OddsCacheStats {
+	double hits;
+	double misses;
+	double flushes;
+	double entries;
+	double valuesUsed;
+	double valuesCapacity;
+};
+
+static struct OddsCacheEntry sharedOddsCacheEntries[ODDS_CACHE_SLOTS];
+static prob_t sharedOddsCacheValues[ODDS_CACHE_VALUES];
+static unsigned int sharedOddsCacheEntryCount = 0;
+static unsigned int sharedOddsCacheValuesUsed = 0;
+static struct OddsCacheStats sharedOddsCacheStats;
+static struct OddsWindow sharedOddsWindow;
+
+EMSCRIPTEN_KEEPALIVE void reset_odds_cache() {
+	for (unsigned int i = 0; i < ODDS_CACHE_SLOTS; ++ i) {
+		sharedOddsCacheEntries[i].total = 0;
+	}
+	sharedOddsCacheEntryCount = 0;
+	sharedOddsCacheValuesUsed = 0;
+}
+
+EMSCRIPTEN_KEEPALIVE const struct OddsCacheStats* get_odds_cache_stats() {
+	sharedOddsCacheStats.entries = sharedOddsCacheEntryCount;
+	sharedOddsCacheStats.valuesUsed = sharedOddsCacheValuesUsed;
+	sharedOddsCacheStats.valuesCapacity = ODDS_CACHE_VALUES;
+	return &sharedOddsCacheStats;
+}
+
+unsigned int odds_cache_slot(
+	unsigned long long total,
+	unsigned long long targets,
+	unsigned int samples
+) {
+	unsigned long long h = total * 0x9E3779B97F4A7C15ull;
+	h ^= targets + 0x7F4A7C159E3779B9ull + (h << 6) + (h >> 2);
+	h ^= samples + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+	return (unsigned int) (h & (ODDS_CACHE_SLOTS - 1));
+}
+
+const struct OddsWindow* window_odds(const struct PositionedList* l) {
+	// Trims zeros from either end of a calculated row
+	unsigned int begin = 0;
+	unsigned int end = l->length;
+	while (begin < end && l->values[begin] <= 0.0) {
+		++ begin;
+	}
+	while (end > begin && l->values[end - 1] <= 0.0) {
+		-- end;
+	}
+	sharedOddsWindow.start = l->start + begin;
+	sharedOddsWindow.length = end - begin;
+	sharedOddsWindow.values = &l->values[begin];
+	return &sharedOddsWindow;
+}
+
+const struct OddsWindow* cached_odds(
+	unsigned long long total,
+	unsigned long long targets,
+	unsigned int samples
+) {
+	// Equivalent to calculate_odds_nopad (with trimmed zeros). The
+	// returned values remain valid until the next call.
+
+	if (samples <= 1 || targets == 0 || targets == total) {
+		// Trivial; not worth storing
+		return window_odds(calculate_odds_nopad(total, targets, samples));
+	}
+
+	unsigned int slot = odds_cache_slot(total, targets, samples);
+	for (;; slot = (slot + 1) & (ODDS_CACHE_SLOTS - 1)) {
+		const struct OddsCacheEntry* e = &sharedOddsCacheEntries[slot];
+		if (e->total == 0) {
+			break;
+		}
+		if (e->total == total && e->targets == targets && e->samples == samples) {
+			++ sharedOddsCacheStats.hits;
+			sharedOddsWindow.start = e->start;
+			sharedOddsWindow.length = e->length;
+			sharedOddsWindow.values = &sharedOddsCacheValues[e->offset];
+			return &sharedOddsWindow;
+		}
+	}
+
+	++ sharedOddsCacheStats.misses;
+	const struct OddsWindow* w = window_odds(
+		calculate_odds_nopad(total, targets, samples)
+	);
+	if (w->length > ODDS_CACHE_VALUES) {
+		return w;
+	}
+
+	if (
+		sharedOddsCacheEntryCount * 2 >= ODDS_CACHE_SLOTS ||
+		sharedOddsCacheValuesUsed + w->length > ODDS_CACHE_VALUES
+	) {
+		++ sharedOddsCacheStats.flushes;
+		reset_odds_cache();
+		slot = odds_cache_slot(total, targets, samples);
+	}
+
+	struct OddsCacheEntry* e = &sharedOddsCacheEntries[slot];
+	e->total = total;
+	e->targets = targets;
+	e->samples = samples;
+	e->start = w->start;
+	e->length = w->length;
+	e->offset = sharedOddsCacheValuesUsed;
+	prob_t* values = &sharedOddsCacheValues[sharedOddsCacheValuesUsed];
+	for (unsigned int i = 0; i < w->length; ++ i) {
+		values[i] = w->values[i];
+	}
+	sharedOddsCacheValuesUsed += w->length;
+	++ sharedOddsCacheEntryCount;
+
+	sharedOddsWindow.values = values;
+	return &sharedOddsWindow;
+}
+
+#endif
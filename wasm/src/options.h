@@ -7,6 +7,20 @@
 #define MAX_ODDS_BUCKETS (MAX_TICKETS + 1)
 #define MAX_CP_ELEMENTS 50000
 #define MAX_MAP_GLOBAL_ITEMS 400000
+#define MAX_SUMMARY_QUERIES 32
+
+// Must be a power of 2
+#define ODDS_CACHE_SLOTS 4096
+#define ODDS_CACHE_VALUES 131072
+#define MAX_HISTOGRAM_BINS 4096
+
+// Build with -DPROB_FLOAT32 to store and combine probabilities in single
+// precision; totals and normalisation are always accumulated as double
+#ifdef PROB_FLOAT32
+typedef float prob_t;
+#else
+typedef double prob_t;
+#endif
 
 #define EXACT_LNF_COUNT 257
 #define CACHE_LNF_COUNT 262144
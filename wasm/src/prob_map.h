@@ -4,7 +4,7 @@
 #include "linkedmap.h"
 #include "options.h"
 
-DEFINE_LINKEDMAP(ProbMap, unsigned int, double, MAX_MAP_GLOBAL_ITEMS)
+DEFINE_LINKEDMAP(ProbMap, unsigned int, prob_t, MAX_MAP_GLOBAL_ITEMS)
 #define iterateProbMap(mapPtr, entryVar, expr) \
 	iterateLinkedMap(ProbMap, mapPtr, entryVar, expr)
 
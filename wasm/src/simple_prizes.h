@@ -0,0 +1,219 @@
+#ifndef SIMPLE_PRIZES_H_
+#define SIMPLE_PRIZES_H_
+
+#include "calculate_odds.h"
+#include "odds_cache.h"
+#include "cumulative_probability.h"
+#include "ln_factorial.h"
+#include "prizes.h"
+#include "options.h"
+#include "imports.h"
+#include <math.h>
+
+/*
+ * Prize tables with only one or two non-zero tiers have closed forms, so
+ * can be written directly to the cumulative probability map without
+ * building any ProbMaps:
+ *
+ * 1 tier (K prizes of value v):
+ *   p(k * v) = hypergeometric(N, K, tickets)[k]
+ *
+ * 2 tiers (K1 of v1, K2 of v2):
+ *   p(a * v1 + b * v2) = p(a) * p(b | a)
+ *   p(a) = hypergeometric(N, K1, tickets)[a]
+ *   p(b | a) = hypergeometric(N - K1, K2, tickets - a)[b]
+ */
+
+struct SimpleTier {
+	unsigned long long count;
+	unsigned int value;
+	unsigned int padding; // explicit padding element to align array
+};
+
+static struct SimpleTier sharedSimpleTiers[2];
+
+unsigned int find_simple_tiers(
+	const struct Prize* prizes,
+	unsigned int prizesLength,
+	unsigned long long* total
+) {
+	// Returns the number of non-zero tiers (or 3 if there are more than 2)
+	unsigned int tiers = 0;
+	*total = 0;
+	for (unsigned int i = 0; i < prizesLength; ++ i) {
+		if (prizes[i].count <= 0) {
+			continue;
+		}
+		*total += (unsigned long long) prizes[i].count;
+		if (prizes[i].value == 0) {
+			continue;
+		}
+		if (tiers == 2) {
+			return 3;
+		}
+		sharedSimpleTiers[tiers].count = (unsigned long long) prizes[i].count;
+		sharedSimpleTiers[tiers].value = prizes[i].value;
+		++ tiers;
+	}
+	return tiers;
+}
+
+double ln_hypergeometric(
+	unsigned long long total,
+	unsigned long long targets,
+	unsigned int samples,
+	unsigned int n
+) {
+	// ln(calculate_odds(total, targets, samples)[n]) (for valid n)
+	const unsigned long long others = total - targets;
+	return (
+		ln_factorial_ratio(targets, targets - n) - ln_factorial(n)
+		+ ln_factorial_ratio(others, others - (samples - n))
+		- ln_factorial(samples - n)
+		- ln_factorial_ratio(total, total - samples) + ln_factorial(samples)
+	);
+}
+
+void sift_down_cumulative_probability(unsigned int i, unsigned int length) {
+	struct CumulativeProbMapElement* data = sharedCPMap.data;
+	for (unsigned int c = i * 2 + 1; c < length; c = i * 2 + 1) {
+		if (c + 1 < length && data[c + 1].value > data[c].value) {
+			++ c;
+		}
+		if (data[c].value <= data[i].value) {
+			return;
+		}
+		const struct CumulativeProbMapElement t = data[i];
+		data[i] = data[c];
+		data[c] = t;
+		i = c;
+	}
+}
+
+void sort_cumulative_probability(unsigned int length) {
+	// Heap sort of the first length elements of sharedCPMap by value
+	struct CumulativeProbMapElement* data = sharedCPMap.data;
+	for (unsigned int i = length / 2; (i --) > 0;) {
+		sift_down_cumulative_probability(i, length);
+	}
+	for (unsigned int end = length; (end --) > 1;) {
+		const struct CumulativeProbMapElement t = data[0];
+		data[0] = data[end];
+		data[end] = t;
+		sift_down_cumulative_probability(0, end);
+	}
+}
+
+unsigned int merge_cumulative_probability(unsigned int length) {
+	// Combines adjacent elements with the same value (after sorting)
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < length; ++ i) {
+		if (count > 0 && sharedCPMap.data[count - 1].value == sharedCPMap.data[i].value) {
+			sharedCPMap.data[count - 1].p += sharedCPMap.data[i].p;
+		} else {
+			sharedCPMap.data[count] = sharedCPMap.data[i];
+			++ count;
+		}
+	}
+	return count;
+}
+
+unsigned int add_odds_elements(
+	unsigned int count,
+	const struct OddsWindow* l,
+	double p,
+	double baseValue,
+	unsigned int value
+) {
+	// Appends p * l[k] at baseValue + k * value, returning the new count
+	// (or MAX_CP_ELEMENTS + 1 if there is not enough space)
+	if (count + l->length > MAX_CP_ELEMENTS) {
+		return MAX_CP_ELEMENTS + 1;
+	}
+	for (unsigned int i = 0; i < l->length; ++ i) {
+		const double pp = p * l->values[i];
+		if (pp > 0.0) {
+			sharedCPMap.data[count].p = pp;
+			sharedCPMap.data[count].value = baseValue + (double) (l->start + i) * value;
+			++ count;
+		}
+	}
+	return count;
+}
+
+unsigned int fill_two_tiers(
+	unsigned long long total,
+	unsigned int tickets
+) {
+	const struct SimpleTier* t1 = &sharedSimpleTiers[0];
+	const struct SimpleTier* t2 = &sharedSimpleTiers[1];
+	const unsigned long long others = total - t1->count;
+	const unsigned int aBegin = (tickets > others) ? (unsigned int) (tickets - others) : 0;
+	const unsigned int aEnd = (t1->count < tickets) ? (unsigned int) t1->count : tickets;
+
+	unsigned int count = 0;
+	for (unsigned int a = aBegin; a <= aEnd; ++ a) {
+		const double p = exp(ln_hypergeometric(total, t1->count, tickets, a));
+		if (p <= 0.0) {
+			continue;
+		}
+		count = add_odds_elements(
+			count,
+			cached_odds(others, t2->count, tickets - a),
+			p,
+			(double) a * t1->value,
+			t2->value
+		);
+		if (count > MAX_CP_ELEMENTS) {
+			break;
+		}
+	}
+	return count;
+}
+
+const struct CumulativeProbMap* calculate_simple_cprobability_map(
+	const struct Prize* prizes,
+	unsigned int prizesLength,
+	unsigned int tickets,
+	double pCutoff
+) {
+	// Returns 0 if the prizes are not simple enough (or the result is too
+	// large), in which case the general calculation should be used
+	if (tickets > MAX_TICKETS) {
+		throw_error();
+	}
+
+	unsigned long long total;
+	const unsigned int tiers = find_simple_tiers(prizes, prizesLength, &total);
+	if (tiers > 2 || tickets > total) {
+		return 0;
+	}
+
+	unsigned int count;
+	if (tiers == 0) {
+		sharedCPMap.data[0].p = 1.0;
+		sharedCPMap.data[0].value = 0.0;
+		count = 1;
+	} else if (tiers == 1) {
+		count = add_odds_elements(
+			0,
+			cached_odds(total, sharedSimpleTiers[0].count, tickets),
+			1.0,
+			0.0,
+			sharedSimpleTiers[0].value
+		);
+	} else {
+		count = fill_two_tiers(total, tickets);
+		if (count <= MAX_CP_ELEMENTS) {
+			sort_cumulative_probability(count);
+			count = merge_cumulative_probability(count);
+		}
+	}
+	if (count > MAX_CP_ELEMENTS) {
+		return 0;
+	}
+
+	return finalise_cumulative_probability(count, pCutoff);
+}
+
+#endif
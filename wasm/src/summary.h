@@ -0,0 +1,164 @@
+#ifndef SUMMARY_H_
+#define SUMMARY_H_
+
+#include "calculate_probability_map.h"
+#include "prob_map.h"
+#include "prizes.h"
+#include "options.h"
+#include "imports.h"
+#include <math.h>
+
+struct Summary {
+	double totalP;
+	double mean;
+	double variance;
+	double min;
+	double max;
+	double mode;
+	unsigned int percentilesLength;
+	unsigned int thresholdsLength;
+	double percentiles[MAX_SUMMARY_QUERIES]; // value at each requested percentile
+	double thresholds[MAX_SUMMARY_QUERIES]; // p(value >= each requested threshold)
+};
+
+static unsigned int sharedPercentileQueriesLength = 0;
+static double sharedPercentileQueries[MAX_SUMMARY_QUERIES];
+static unsigned int sharedThresholdQueriesLength = 0;
+static double sharedThresholdQueries[MAX_SUMMARY_QUERIES];
+
+static struct Summary sharedSummary;
+
+EMSCRIPTEN_KEEPALIVE void reset_summary_queries() {
+	sharedPercentileQueriesLength = 0;
+	sharedThresholdQueriesLength = 0;
+}
+
+EMSCRIPTEN_KEEPALIVE void add_percentile_query(double percent) {
+	if (sharedPercentileQueriesLength >= MAX_SUMMARY_QUERIES) {
+		throw_error();
+	}
+	sharedPercentileQueries[sharedPercentileQueriesLength] = percent * 0.01;
+	++ sharedPercentileQueriesLength;
+}
+
+EMSCRIPTEN_KEEPALIVE void add_threshold_query(double value) {
+	if (sharedThresholdQueriesLength >= MAX_SUMMARY_QUERIES) {
+		throw_error();
+	}
+	sharedThresholdQueries[sharedThresholdQueriesLength] = value;
+	++ sharedThresholdQueriesLength;
+}
+
+const struct Summary* summarise_probability_map(
+	const struct ProbMap* pMap,
+	double pCutoff
+) {
+	/*
+	 * Equivalent to reading the results of extract_cumulative_probability,
+	 * but without storing the elements. Percentiles use the same rule as
+	 * Results.percentile (the first value whose cumulative p reaches the
+	 * requested fraction).
+	 */
+
+	const unsigned int nP = sharedPercentileQueriesLength;
+	const unsigned int nT = sharedThresholdQueriesLength;
+	sharedSummary.percentilesLength = nP;
+	sharedSummary.thresholdsLength = nT;
+
+	double totalP = 0.0;
+	double sum = 0.0;
+	double sum2 = 0.0;
+	double bestP = 0.0;
+	sharedSummary.mode = 0.0;
+	sharedSummary.min = 0.0;
+	sharedSummary.max = 0.0;
+	iterateProbMap(pMap, iter, {
+		if (iter->value > pCutoff) {
+			const double value = iter->key;
+			if (totalP == 0.0) {
+				sharedSummary.min = value;
+			}
+			sharedSummary.max = value;
+			totalP += iter->value;
+			sum += iter->value * value;
+			sum2 += iter->value * value * value;
+			if (iter->value >= bestP) {
+				bestP = iter->value;
+				sharedSummary.mode = value;
+			}
+		}
+	})
+
+	sharedSummary.totalP = totalP;
+	if (totalP <= 0.0) {
+		sharedSummary.mean = 0.0;
+		sharedSummary.variance = 0.0;
+		for (unsigned int i = 0; i < nP; ++ i) {
+			sharedSummary.percentiles[i] = 0.0;
+		}
+		for (unsigned int i = 0; i < nT; ++ i) {
+			sharedSummary.thresholds[i] = 0.0;
+		}
+		return &sharedSummary;
+	}
+
+	sharedSummary.mean = sum / totalP;
+	sharedSummary.variance = sum2 / totalP - sharedSummary.mean * sharedSummary.mean;
+	if (sharedSummary.variance < 0.0) {
+		sharedSummary.variance = 0.0;
+	}
+
+	for (unsigned int i = 0; i < nP; ++ i) {
+		sharedSummary.percentiles[i] = sharedSummary.max;
+	}
+	for (unsigned int i = 0; i < nT; ++ i) {
+		sharedSummary.thresholds[i] = 0.0;
+	}
+
+	double cp = 0.0;
+	double previousCP = -INFINITY;
+	iterateProbMap(pMap, iter, {
+		if (iter->value > pCutoff) {
+			const double value = iter->key;
+			const double p = iter->value / totalP;
+			cp += p;
+			for (unsigned int i = 0; i < nP; ++ i) {
+				const double frac = sharedPercentileQueries[i];
+				if (frac < 1.0 && frac > previousCP && cp >= frac) {
+					sharedSummary.percentiles[i] = value;
+				}
+			}
+			for (unsigned int i = 0; i < nT; ++ i) {
+				if (value >= sharedThresholdQueries[i]) {
+					sharedSummary.thresholds[i] += p;
+				}
+			}
+			previousCP = cp;
+		}
+	})
+
+	for (unsigned int i = 0; i < nT; ++ i) {
+		if (sharedSummary.thresholds[i] > 1.0) {
+			sharedSummary.thresholds[i] = 1.0;
+		}
+	}
+
+	return &sharedSummary;
+}
+
+EMSCRIPTEN_KEEPALIVE const struct Summary* calculate_summary(
+	unsigned int tickets,
+	double pCutoff
+) {
+	struct ProbMap* pMap = calculate_probability_map(
+		sharedPrizes,
+		sharedPrizesLength,
+		tickets,
+		pCutoff
+	);
+	const struct Summary* summary = summarise_probability_map(pMap, pCutoff);
+	freeProbMap(pMap);
+	return summary;
+}
+
+#endif
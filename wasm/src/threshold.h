@@ -0,0 +1,229 @@
+#ifndef THRESHOLD_H_
+#define THRESHOLD_H_
+
+#include "calculate_odds.h"
+#include "odds_cache.h"
+#include "calculate_probability_map.h"
+#include "prob_map.h"
+#include "prizes.h"
+#include "options.h"
+#include "imports.h"
+
+struct ThresholdProbability {
+	double above; // p(value >= threshold)
+	double below; // p(value < threshold)
+	double error; // p discarded without knowing which side it falls
+};
+
+static struct ThresholdProbability sharedThresholdProbability;
+
+// Prizes ordered by value (lowest first)
+static unsigned int sharedPrizeOrder[MAX_PRIZES];
+
+// Cumulative counts and values of the remaining prizes, lowest value first
+// (used to bound the value which the remaining tickets can add)
+static unsigned int sharedGainLength = 0;
+static double sharedGainCounts[MAX_PRIZES];
+static double sharedGainTotals[MAX_PRIZES];
+static double sharedGainValues[MAX_PRIZES];
+
+static double sharedThresholdValue = 0.0;
+static double sharedThresholdBudget = 0.0;
+
+void sort_prizes_by_value(const struct Prize* prizes, unsigned int length) {
+	for (unsigned int i = 0; i < length; ++ i) {
+		unsigned int j = i;
+		for (; j > 0 && prizes[sharedPrizeOrder[j - 1]].value > prizes[i].value; -- j) {
+			sharedPrizeOrder[j] = sharedPrizeOrder[j - 1];
+		}
+		sharedPrizeOrder[j] = i;
+	}
+}
+
+void prepare_gain_bounds(
+	const struct Prize* prizes,
+	unsigned int length,
+	unsigned int begin
+) {
+	// Only prizes from begin onwards remain to be applied
+	double count = 0.0;
+	double total = 0.0;
+	sharedGainLength = 0;
+	for (unsigned int i = 0; i < length; ++ i) {
+		const struct Prize* prize = &prizes[sharedPrizeOrder[i]];
+		if (sharedPrizeOrder[i] < begin || prize->count <= 0) {
+			continue;
+		}
+		count += (double) prize->count;
+		total += (double) prize->count * prize->value;
+		sharedGainCounts[sharedGainLength] = count;
+		sharedGainTotals[sharedGainLength] = total;
+		sharedGainValues[sharedGainLength] = prize->value;
+		++ sharedGainLength;
+	}
+}
+
+double gain_bound(unsigned int tickets, int highest) {
+	// Total value of the lowest (or highest) value prizes which the
+	// given number of tickets could win
+	if (sharedGainLength == 0) {
+		return 0.0;
+	}
+	const double all = sharedGainCounts[sharedGainLength - 1];
+	if (tickets >= all) {
+		return sharedGainTotals[sharedGainLength - 1];
+	}
+	// Taking the highest n prizes = everything minus the lowest (all - n)
+	const double n = highest ? (all - tickets) : (double) tickets;
+
+	// Find the first group which has not been fully used
+	unsigned int p0 = 0;
+	unsigned int p1 = sharedGainLength - 1;
+	while (p0 < p1) {
+		const unsigned int p = (p0 + p1) / 2;
+		if (sharedGainCounts[p] > n) {
+			p1 = p;
+		} else {
+			p0 = p + 1;
+		}
+	}
+	double lowest = n * sharedGainValues[p0];
+	if (p0 > 0) {
+		lowest += sharedGainTotals[p0 - 1];
+		lowest -= sharedGainCounts[p0 - 1] * sharedGainValues[p0];
+	}
+	return highest ? (sharedGainTotals[sharedGainLength - 1] - lowest) : lowest;
+}
+
+int discard_probability(double p, double limit) {
+	if (p <= limit && p <= sharedThresholdBudget) {
+		sharedThresholdBudget -= p;
+		return 1;
+	}
+	return 0;
+}
+
+void accumulate_bounded(
+	struct ProbMap* target,
+	unsigned int remainingTickets,
+	unsigned int value,
+	double p
+) {
+	// Collapse anything which is certainly above or below the threshold
+	if (value + gain_bound(remainingTickets, 0) >= sharedThresholdValue) {
+		sharedThresholdProbability.above += p;
+	} else if (value + gain_bound(remainingTickets, 1) < sharedThresholdValue) {
+		sharedThresholdProbability.below += p;
+	} else {
+		accumulateProbMap(target, value, (prob_t) p);
+	}
+}
+
+void apply_distribution_bounded(
+	struct ProbMap** prob,
+	unsigned int limit,
+	unsigned long long audience,
+	const struct Prize* prize,
+	double tolerance
+) {
+	// Equivalent to apply_distribution, but with pruning limited to a total
+	// budget of discarded probability rather than a fixed cutoff
+	const double tolerance2 = tolerance * tolerance;
+
+	for (unsigned int n = limit - 1; (n --) > 0;) {
+		if (isEmptyProbMap(prob[n])) {
+			continue;
+		}
+
+		const struct OddsWindow* l = cached_odds(
+			audience,
+			prize->count,
+			limit - n - 1
+		);
+		struct ProbMap* prevPN = prob[n];
+		prob[n] = mallocProbMap();
+
+		iterateProbMap(prevPN, iter, {
+			if (discard_probability(iter->value, tolerance)) {
+				continue;
+			}
+			for (unsigned int i = 0; i < l->length; ++ i) {
+				const prob_t pp = iter->value * l->values[i];
+				if (pp <= 0.0 || discard_probability(pp, tolerance2)) {
+					continue;
+				}
+				const unsigned int d = i + l->start;
+				accumulate_bounded(
+					prob[n + d],
+					limit - 1 - n - d,
+					iter->key + d * prize->value,
+					pp
+				);
+			}
+		})
+
+		freeProbMap(prevPN);
+	}
+}
+
+EMSCRIPTEN_KEEPALIVE const struct ThresholdProbability* calculate_threshold(
+	unsigned int tickets,
+	double threshold,
+	double tolerance
+) {
+	/*
+	 * Calculates p(value >= threshold) without building the full
+	 * distribution. Each element carries bounds on the value it can
+	 * still reach given its remaining tickets and the remaining prizes;
+	 * once the bounds are both on one side of the threshold, its
+	 * probability is moved into a single scalar for that side.
+	 *
+	 * Since the final prize always adds exactly (remaining tickets *
+	 * value), every element is resolved by the end of the penultimate
+	 * prize.
+	 */
+
+	if (tickets > MAX_TICKETS) {
+		throw_error();
+	}
+
+	sharedThresholdValue = threshold;
+	sharedThresholdBudget = tolerance;
+	sharedThresholdProbability.above = 0.0;
+	sharedThresholdProbability.below = 0.0;
+
+	for (unsigned int i = 0; i <= tickets; ++ i) {
+		sharedTicketsProb[i] = mallocProbMap();
+	}
+
+	unsigned long long remainingAudience = 0;
+	for (unsigned int p = 0; p < sharedPrizesLength; ++ p) {
+		remainingAudience += sharedPrizes[p].count;
+	}
+
+	// Begin with no tickets spent (value = 0, p = 1)
+	sort_prizes_by_value(sharedPrizes, sharedPrizesLength);
+	prepare_gain_bounds(sharedPrizes, sharedPrizesLength, 0);
+	accumulate_bounded(sharedTicketsProb[0], tickets, 0, 1.0);
+
+	for (unsigned int p = 0; p + 1 < sharedPrizesLength; ++ p) {
+		prepare_gain_bounds(sharedPrizes, sharedPrizesLength, p + 1);
+		apply_distribution_bounded(
+			sharedTicketsProb,
+			tickets + 1,
+			remainingAudience,
+			&sharedPrizes[p],
+			tolerance
+		);
+		remainingAudience -= sharedPrizes[p].count;
+	}
+
+	for (unsigned int i = 0; i <= tickets; ++ i) {
+		freeProbMap(sharedTicketsProb[i]);
+	}
+
+	sharedThresholdProbability.error = tolerance - sharedThresholdBudget;
+	return &sharedThresholdProbability;
+}
+
+#endif